@@ -73,6 +73,19 @@ build_for_abi() {
     $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/BertEmbedder.cpp -o $BUILD_DIR/BertEmbedder.o
     $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/TextEmbedder.cpp -o $BUILD_DIR/TextEmbedder.o
     $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/SimilaritySearch.cpp -o $BUILD_DIR/SimilaritySearch.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/VectorOps.cpp -o $BUILD_DIR/VectorOps.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/ThreadPool.cpp -o $BUILD_DIR/ThreadPool.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/HnswIndex.cpp -o $BUILD_DIR/HnswIndex.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/IvfIndex.cpp -o $BUILD_DIR/IvfIndex.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/ProductQuantizer.cpp -o $BUILD_DIR/ProductQuantizer.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/RawVectorFile.cpp -o $BUILD_DIR/RawVectorFile.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/ScalarQuantizer.cpp -o $BUILD_DIR/ScalarQuantizer.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/HalfVectorStore.cpp -o $BUILD_DIR/HalfVectorStore.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/BinaryCodeStore.cpp -o $BUILD_DIR/BinaryCodeStore.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/MappedFile.cpp -o $BUILD_DIR/MappedFile.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/VocabHashTable.cpp -o $BUILD_DIR/VocabHashTable.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/DoubleArrayTrie.cpp -o $BUILD_DIR/DoubleArrayTrie.o
+    $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/src/Log.cpp -o $BUILD_DIR/Log.o
     $CXX_COMPILER $CXXFLAGS -c $PROJECT_ROOT/jni/com_example_w2v_W2VNative.cpp -o $BUILD_DIR/W2VNative.o
     
     # 链接生成 .so 文件
@@ -82,6 +95,19 @@ build_for_abi() {
         $BUILD_DIR/BertEmbedder.o \
         $BUILD_DIR/TextEmbedder.o \
         $BUILD_DIR/SimilaritySearch.o \
+        $BUILD_DIR/VectorOps.o \
+        $BUILD_DIR/ThreadPool.o \
+        $BUILD_DIR/HnswIndex.o \
+        $BUILD_DIR/IvfIndex.o \
+        $BUILD_DIR/ProductQuantizer.o \
+        $BUILD_DIR/RawVectorFile.o \
+        $BUILD_DIR/ScalarQuantizer.o \
+        $BUILD_DIR/HalfVectorStore.o \
+        $BUILD_DIR/BinaryCodeStore.o \
+        $BUILD_DIR/MappedFile.o \
+        $BUILD_DIR/VocabHashTable.o \
+        $BUILD_DIR/DoubleArrayTrie.o \
+        $BUILD_DIR/Log.o \
         $BUILD_DIR/W2VNative.o \
         -o $OUTPUT_DIR/libw2v_jni.so
         
@@ -4,19 +4,40 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 #ifndef DISABLE_BERT
 #include "onnxruntime_cxx_api.h"
 #endif
 
+// 模型输入节点名；为空的一项按名称自动识别：含 "type" / "segment" 或为 "input.3" 的是 token_type_ids，
+// 含 "mask" 或为 "input.2" 的是 attention_mask，其余为 input_ids
+struct BertInputConfig {
+    std::string input_ids;
+    std::string attention_mask;
+    std::string token_type_ids;
+};
+
 class BertEmbedder {
 public:
     BertEmbedder();
     ~BertEmbedder();
     
+    // 可重复调用以换模型，但不可与 embed / embed_batch 并发
     bool initialize(const std::string& model_path, const std::string& vocab_path);
     
     std::vector<float> embed(const std::string& text);
+    
+    // 批量推理：每次 Run 把最多 max_batch_size 条文本打包成一个 [N, seq_len] 输入
+    // （模型需导出动态 batch 维，scripts/convert_model.py 导出的模型满足）；推理失败的批次对应结果为空向量
+    std::vector<std::vector<float> > embed_batch(const std::vector<std::string>& texts);
+    
+    // 单次推理的最大条数（默认 32）：越大 Run 次数越少，峰值内存随之增加
+    void set_max_batch_size(size_t max_batch_size);
+    
+    // 输入节点名映射，需在 initialize 前设置；指定的名称在模型中不存在时 initialize 失败
+    void set_input_config(const BertInputConfig& config);
+    
     int get_embedding_dim() const;
     size_t get_memory_usage() const;
     bool is_initialized() const { return initialized_; }
@@ -24,6 +45,8 @@ public:
 private:
     bool initialized_;
     int embedding_dim_;
+    size_t max_batch_size_;
+    BertInputConfig input_config_;
     
 #ifndef DISABLE_BERT
     std::unique_ptr<Ort::Env> env_;
@@ -36,6 +59,40 @@ private:
     std::vector<Ort::AllocatedStringPtr> input_node_names_allocated_;
     std::vector<Ort::AllocatedStringPtr> output_node_names_allocated_;
     size_t max_seq_len_ = 128;
+    // 各输入节点的角色，initialize 时按名称解析一次
+    enum InputRole {
+        ROLE_INPUT_IDS,
+        ROLE_ATTENTION_MASK,
+        ROLE_TOKEN_TYPE_IDS
+    };
+    std::vector<InputRole> input_roles_;
+    // 模型输入的序列维为动态时按批内实际 token 数（取整到分桶长度）推理，否则补齐到 max_seq_len_
+    bool dynamic_seq_len_ = false;
+    
+    // 推理上下文：预分配的输入输出缓冲（max_batch_size_ × max_seq_len_）与按 (条数, 序列长度) 缓存的 IoBinding，
+    // 各形状的张量是缓冲前缀上的视图，绑定一次后反复使用，推理时只写入 token 再 Run。
+    // 每次推理从空闲池取出一个上下文独占使用、用完归还，因此多个线程的 Session::Run 可以并行；
+    // 并发推理数超过 kMaxIdleContexts 时多出的上下文用完即释放
+    struct BoundShape;
+    struct RunContext;
+    std::vector<std::unique_ptr<RunContext> > idle_contexts_;
+    // initialize / set_max_batch_size 后递增；旧代上下文的缓冲尺寸或绑定的会话已失效，归还时直接释放
+    size_t context_generation_ = 0;
+    size_t output_rank_ = 2;
+    // 保护 max_batch_size_、idle_contexts_ 与 context_generation_，Run 期间不持有
+    std::mutex context_mutex_;
+    
+    bool resolve_input_roles();
+    size_t bucket_seq_len(size_t length) const;
+    // 取出一个容量不小于 count 条的上下文；count 超过当前 max_batch_size_ 时返回空
+    std::unique_ptr<RunContext> acquire_context(size_t count);
+    void release_context(std::unique_ptr<RunContext> context);
+    BoundShape& bind_shape(RunContext& context, size_t count, size_t seq_len);
+    bool run_with_context(RunContext& context, const std::vector<std::vector<int64_t> >& token_ids,
+                          const size_t* indices, size_t count, std::vector<std::vector<float> >& results);
+    // 对 token_ids[indices[0 .. count)]（未补齐）做一次推理，未归一化的句向量写入 results 的相同下标
+    bool run_batch(const std::vector<std::vector<int64_t> >& token_ids, const size_t* indices, size_t count,
+                   std::vector<std::vector<float> >& results);
 #endif
 };
 
@@ -1,9 +1,11 @@
 #ifndef BERT_TOKENIZER_H
 #define BERT_TOKENIZER_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include "VocabHashTable.h"
 
 class BertTokenizer {
 public:
@@ -11,13 +13,16 @@ public:
     
     bool load_vocab(const std::string& vocab_path);
     
-    std::vector<int64_t> tokenize(const std::string& text, size_t max_len);
+    // [CLS] + 词 + [SEP]，最多 max_len 个 token；pad 为 true 时用 [PAD] 补齐到 max_len
+    std::vector<int64_t> tokenize(const std::string& text, size_t max_len, bool pad = true);
     
     bool is_initialized() const { return initialized_; }
     int64_t get_pad_id() const { return pad_id_; }
 
 private:
-    std::unordered_map<std::string, int64_t> vocab_;
+    // 词 -> 行，vocab_ids_[行] 为 token id（词表文件中的行号，重复的词以最后一次为准）
+    VocabHashTable vocab_;
+    std::vector<int64_t> vocab_ids_;
     bool initialized_;
     
     int64_t cls_id_ = 101;
@@ -25,8 +30,12 @@ private:
     int64_t unk_id_ = 100;
     int64_t pad_id_ = 0;
 
-    std::vector<std::string> split_text(const std::string& text);
-    void wordpiece_tokenize(const std::string& token, std::vector<int64_t>& ids);
+    // 不在词表中时返回 -1
+    int64_t lookup(std::string_view token) const;
+    // 预处理后的文本写入 clean_text，切分出的词以指向 clean_text 的 string_view 给出
+    void split_text(const std::string& text, std::string& clean_text, std::vector<std::string_view>& tokens) const;
+    // buffer 为拼接 "##" 前缀的复用缓冲
+    void wordpiece_tokenize(std::string_view token, std::string& buffer, std::vector<int64_t>& ids) const;
 };
 
 #endif // BERT_TOKENIZER_H
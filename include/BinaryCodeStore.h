@@ -0,0 +1,51 @@
+#ifndef BINARY_CODE_STORE_H
+#define BINARY_CODE_STORE_H
+
+#include "TopKHeap.h"
+#include "VectorOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// 二值（符号位）编码：每维只保留 (x - mean) 的符号，按位打包为 64 位字，体积为 float 的 1/32
+// 汉明距离越小两向量夹角越小，只适合作为第一阶段筛选候选，得分须再用原始向量精确重排
+// 减去全库均值可抵消嵌入向量各维的公共偏移，使符号位分布更均衡
+class BinaryCodeStore {
+public:
+    BinaryCodeStore();
+
+    // 以视图前 count 行的均值为中心编码全部行
+    void build(const VectorView& vectors, size_t count);
+
+    void add(const float* vec);
+
+    // 按相同规则编码查询，写入 out[code_words()]
+    void encode(const float* vec, uint64_t* out) const;
+
+    // [begin, end) 行按汉明距离从小到大筛选，得分为 -距离
+    void scan(const uint64_t* query, size_t begin, size_t end, TopKHeap& heap) const;
+
+    size_t code_words() const { return words_; }
+    size_t size() const { return count_; }
+    size_t dim() const { return dim_; }
+    bool empty() const { return count_ == 0; }
+    size_t get_memory_usage() const;
+
+    // 写入 / 读取索引文件中的一段（由 SimilaritySearch 快照调用），读取失败时清空并返回 false
+    void save(BinaryWriter& out) const;
+    bool load(BinaryReader& in);
+
+    void clear();
+
+private:
+    size_t dim_;
+    size_t words_;
+    std::vector<float> mean_;
+    std::vector<uint64_t> codes_;   // 行主序 [count, words]
+    size_t count_;
+};
+
+#endif // BINARY_CODE_STORE_H
@@ -0,0 +1,157 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 索引文件的二进制读写工具：按本机字节序写入定长字段与数组，文件只在同一设备 / 同一架构上复用
+
+// 文件分段对齐字节数：段数据按此对齐，映射到内存后可直接作为对齐的向量矩阵使用
+const size_t kFileSectionAlign = 64;
+
+// FNV-1a 64 位哈希，seed 可串联多段数据
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+class BinaryWriter {
+public:
+    explicit BinaryWriter(const std::string& path)
+        : file_(path.c_str(), std::ios::binary | std::ios::trunc), section_start_(0) {}
+
+    bool ok() const { return file_.good(); }
+
+    uint64_t position() { return static_cast<uint64_t>(file_.tellp()); }
+
+    void write(const void* data, size_t size) {
+        if (size > 0) file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+    template <typename T>
+    void write_pod(const T& value) { write(&value, sizeof(T)); }
+
+    // 先写元素个数再写数据
+    template <typename T, typename A>
+    void write_vector(const std::vector<T, A>& values) {
+        write_pod<uint64_t>(values.size());
+        write(values.data(), values.size() * sizeof(T));
+    }
+
+    // 补零到 kFileSectionAlign 的整数倍
+    void align() {
+        static const char zeros[kFileSectionAlign] = {};
+        size_t rem = static_cast<size_t>(position() % kFileSectionAlign);
+        if (rem) write(zeros, kFileSectionAlign - rem);
+    }
+
+    // 段结构：[id:u32][reserved:u32][size:u64] + 对齐填充 + 数据；size 在 end_section() 时回填
+    void begin_section(uint32_t id) {
+        align();
+        section_start_ = position();
+        write_pod(id);
+        write_pod<uint32_t>(0);
+        write_pod<uint64_t>(0);
+        align();
+        payload_start_ = position();
+    }
+
+    void end_section() {
+        uint64_t end = position();
+        uint64_t size = end - payload_start_;
+        file_.seekp(static_cast<std::streamoff>(section_start_ + 8));
+        write_pod(size);
+        file_.seekp(static_cast<std::streamoff>(end));
+    }
+
+    bool close() {
+        file_.close();
+        return !file_.fail();
+    }
+
+private:
+    std::ofstream file_;
+    uint64_t section_start_;
+    uint64_t payload_start_;
+};
+
+// 内存中的只读游标（通常指向映射的文件），越界读取后 ok() 为 false
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t size) : data_(data), size_(size), pos_(0), ok_(true) {}
+
+    bool ok() const { return ok_; }
+    size_t position() const { return pos_; }
+    size_t remaining() const { return ok_ ? size_ - pos_ : 0; }
+    const char* current() const { return data_ + pos_; }
+
+    bool read(void* out, size_t size) {
+        if (!ok_ || size > size_ - pos_) {
+            ok_ = false;
+            return false;
+        }
+        if (size > 0) std::memcpy(out, data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool skip(size_t size) {
+        if (!ok_ || size > size_ - pos_) {
+            ok_ = false;
+            return false;
+        }
+        pos_ += size;
+        return true;
+    }
+
+    template <typename T>
+    bool read_pod(T& value) { return read(&value, sizeof(T)); }
+
+    template <typename T, typename A>
+    bool read_vector(std::vector<T, A>& values) {
+        uint64_t count = 0;
+        if (!read_pod(count) || count > remaining() / sizeof(T)) {
+            ok_ = false;
+            return false;
+        }
+        values.resize(static_cast<size_t>(count));
+        return read(values.data(), values.size() * sizeof(T));
+    }
+
+    // 跳到下一个 kFileSectionAlign 边界（相对数据起点，数据起点须已对齐）
+    bool align() {
+        size_t rem = pos_ % kFileSectionAlign;
+        return rem == 0 || skip(kFileSectionAlign - rem);
+    }
+
+    // 读取下一段的段头，返回段数据的读取器；文件结束或格式错误时返回 false
+    bool next_section(uint32_t& id, BinaryReader& payload) {
+        uint32_t reserved = 0;
+        uint64_t size = 0;
+        if (!align() || remaining() == 0) return false;
+        if (!read_pod(id) || !read_pod(reserved) || !read_pod(size) || !align() || size > remaining()) {
+            ok_ = false;
+            return false;
+        }
+        payload = BinaryReader(current(), static_cast<size_t>(size));
+        pos_ += static_cast<size_t>(size);
+        return true;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    bool ok_;
+};
+
+#endif // BINARY_IO_H
@@ -0,0 +1,59 @@
+#ifndef DOUBLE_ARRAY_TRIE_H
+#define DOUBLE_ARRAY_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 按字节建立的双数组 Trie：状态 s 经字节 c 转移到 t = base[s] + c + 1，且要求 check[t] == s。
+// 用于正向最大匹配分词：从文本某一位置单趟向前走，沿途记录最后一个词尾即为最长匹配，不分配内存、不做哈希
+class DoubleArrayTrie {
+public:
+    static const uint32_t kNoValue = 0xffffffffu;
+
+    DoubleArrayTrie();
+
+    // keys 须按字节序升序且互不相同，values[i] 为 keys[i] 对应的值；空串被忽略
+    void build(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values);
+
+    // 从 text 开头起的最长匹配：返回匹配的字节数（无匹配时为 0），value 写入该词的值
+    size_t longest_match(const char* text, size_t len, uint32_t& value) const {
+        size_t matched = 0;
+        uint32_t state = 0;
+        for (size_t i = 0; i < len; ++i) {
+            uint32_t next = static_cast<uint32_t>(units_[state].base) + static_cast<unsigned char>(text[i]) + 1;
+            if (next >= units_.size() || units_[next].check != static_cast<int32_t>(state)) break;
+            state = next;
+            if (units_[state].value != kNoValue) {
+                matched = i + 1;
+                value = units_[state].value;
+            }
+        }
+        return matched;
+    }
+
+    bool empty() const { return units_.size() <= 1; }
+    size_t get_memory_usage() const { return units_.capacity() * sizeof(Unit); }
+
+    void clear();
+
+private:
+    struct Unit {
+        int32_t base;       // 子节点偏移，叶子为 0
+        int32_t check;      // 父状态，-1 表示空闲
+        uint32_t value;     // 以该状态结尾的词的值，不是词尾时为 kNoValue
+    };
+
+    // 为 keys[begin, end)（共享长度为 depth 的前缀，对应状态 state）放置子节点并递归
+    void insert_children(uint32_t state, size_t begin, size_t end, size_t depth);
+    void ensure_size(size_t size);
+
+    std::vector<Unit> units_;
+    std::vector<bool> used_base_;       // 构建期：已被占用的 base，避免两个状态共用同一 base
+    size_t next_check_pos_;             // 构建期：空闲位置搜索的起点
+    const std::vector<std::string_view>* keys_;
+    const std::vector<uint32_t>* values_;
+};
+
+#endif // DOUBLE_ARRAY_TRIE_H
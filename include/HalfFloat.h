@@ -0,0 +1,108 @@
+#ifndef HALF_FLOAT_H
+#define HALF_FLOAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 16 位浮点格式
+enum HalfType {
+    HALF_FP16,      // IEEE 754 binary16：10 位尾数，范围 ±65504，适合归一化向量
+    HALF_BF16       // bfloat16：与 float 同样的 8 位指数、7 位尾数，转换只需截取高 16 位
+};
+
+// 向量表的存储精度（词向量表等）
+enum VectorPrecision {
+    PRECISION_FLOAT32,
+    PRECISION_FP16,
+    PRECISION_BF16
+};
+
+namespace half_detail {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+} // namespace half_detail
+
+// float -> fp16，就近舍入到偶数；超出范围为 ±inf，NaN 保持 NaN
+inline uint16_t float_to_fp16(float value) {
+    using namespace half_detail;
+    const uint32_t f32_inf = 255u << 23;
+    const uint32_t f16_max = (127u + 16u) << 23;
+    const float denorm_magic = bits_float(((127u - 15u) + (23u - 10u) + 1u) << 23);
+
+    uint32_t x = float_bits(value);
+    uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint16_t out;
+    if (x >= f16_max) {
+        out = x > f32_inf ? 0x7e00 : 0x7c00;
+    } else if (x < (113u << 23)) {
+        // 结果为 fp16 非规格化数：借助浮点加法完成对齐与舍入
+        out = static_cast<uint16_t>(float_bits(bits_float(x) + denorm_magic) - float_bits(denorm_magic));
+    } else {
+        uint32_t mant_odd = (x >> 13) & 1u;
+        x += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu;
+        x += mant_odd;
+        out = static_cast<uint16_t>(x >> 13);
+    }
+    return static_cast<uint16_t>(out | (sign >> 16));
+}
+
+inline float fp16_to_float(uint16_t value) {
+    using namespace half_detail;
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t out = (value & 0x7fffu) << 13;
+    uint32_t exp = shifted_exp & out;
+    out += (127u - 15u) << 23;
+    if (exp == shifted_exp) {
+        out += (128u - 16u) << 23;          // inf / NaN
+    } else if (exp == 0) {
+        out += 1u << 23;                    // 零 / 非规格化数
+        out = float_bits(bits_float(out) - bits_float(113u << 23));
+    }
+    return bits_float(out | (static_cast<uint32_t>(value & 0x8000u) << 16));
+}
+
+// float -> bf16，就近舍入到偶数
+inline uint16_t float_to_bf16(float value) {
+    uint32_t x = half_detail::float_bits(value);
+    if ((x & 0x7fffffffu) > 0x7f800000u) {
+        return static_cast<uint16_t>((x >> 16) | 0x40u);
+    }
+    x += 0x7fffu + ((x >> 16) & 1u);
+    return static_cast<uint16_t>(x >> 16);
+}
+
+inline float bf16_to_float(uint16_t value) {
+    return half_detail::bits_float(static_cast<uint32_t>(value) << 16);
+}
+
+inline void float_to_half(const float* src, uint16_t* dst, size_t n, HalfType type) {
+    if (type == HALF_FP16) {
+        for (size_t i = 0; i < n; ++i) dst[i] = float_to_fp16(src[i]);
+    } else {
+        for (size_t i = 0; i < n; ++i) dst[i] = float_to_bf16(src[i]);
+    }
+}
+
+inline void half_to_float(const uint16_t* src, float* dst, size_t n, HalfType type) {
+    if (type == HALF_FP16) {
+        for (size_t i = 0; i < n; ++i) dst[i] = fp16_to_float(src[i]);
+    } else {
+        for (size_t i = 0; i < n; ++i) dst[i] = bf16_to_float(src[i]);
+    }
+}
+
+#endif // HALF_FLOAT_H
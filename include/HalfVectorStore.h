@@ -0,0 +1,49 @@
+#ifndef HALF_VECTOR_STORE_H
+#define HALF_VECTOR_STORE_H
+
+#include "AlignedAllocator.h"
+#include "HalfFloat.h"
+#include "TopKHeap.h"
+#include "VectorOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// 半精度（fp16 / bf16）向量矩阵：内存与扫描带宽为 float 的一半，检索时在寄存器内转换为 float 计算，
+// 精度远高于 int8；无需训练，可随时增量追加
+class HalfVectorStore {
+public:
+    HalfVectorStore();
+
+    // 转换视图前 count 行
+    void build(const VectorView& vectors, size_t count, HalfType type);
+
+    void add(const float* vec);
+
+    // 计算 [begin, end) 行与 float 查询的内积，候选写入 heap
+    void scan(const float* query, size_t begin, size_t end, TopKHeap& heap) const;
+
+    HalfType type() const { return type_; }
+    size_t size() const { return count_; }
+    size_t dim() const { return dim_; }
+    bool empty() const { return count_ == 0; }
+    size_t get_memory_usage() const;
+
+    // 写入 / 读取索引文件中的一段（由 SimilaritySearch 快照调用），读取失败时清空并返回 false
+    void save(BinaryWriter& out) const;
+    bool load(BinaryReader& in);
+
+    void clear();
+
+private:
+    HalfType type_;
+    size_t dim_;
+    size_t stride_;
+    std::vector<uint16_t, AlignedAllocator<uint16_t, 64> > rows_;  // 行主序 [count, stride]
+    size_t count_;
+};
+
+#endif // HALF_VECTOR_STORE_H
@@ -0,0 +1,97 @@
+#ifndef HNSW_INDEX_H
+#define HNSW_INDEX_H
+
+#include "TopKHeap.h"
+#include "VectorOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// HNSW 图索引参数
+struct HnswConfig {
+    int M;                  // 每层每个节点的最大邻居数（第 0 层为 2M）
+    int ef_construction;    // 构建时的候选队列长度，越大图质量越好、构建越慢
+    int ef_search;          // 检索时的候选队列长度（实际取 max(ef_search, top_k)），越大召回越高
+
+    HnswConfig() : M(16), ef_construction(200), ef_search(64) {}
+};
+
+// 基于内积相似度的 HNSW（Hierarchical Navigable Small World）近似最近邻图
+// 只保存图结构，不复制向量；要求向量已 L2 归一化，此时内积即余弦相似度
+// 构建与插入需串行调用，检索可并发
+class HnswIndex {
+public:
+    HnswIndex();
+    ~HnswIndex();
+
+    // 对视图中的全部行重建索引
+    void build(const VectorView& vectors, size_t count, const HnswConfig& config);
+
+    // 追加第 size() 行（向量须已写入视图）
+    void add(const VectorView& vectors);
+
+    // 返回得分最高的 top_k 个候选（降序），ef 为检索候选队列长度
+    std::vector<TopKHeap::Entry> search(const VectorView& vectors, const float* query,
+                                        size_t top_k, size_t ef) const;
+
+    size_t size() const { return levels_.size(); }
+    bool empty() const { return levels_.empty(); }
+    const HnswConfig& config() const { return config_; }
+    size_t get_memory_usage() const;
+
+    // 写入 / 读取索引文件中的一段（由 SimilaritySearch 快照调用），读取失败时清空并返回 false
+    void save(BinaryWriter& out) const;
+    bool load(BinaryReader& in);
+
+    void clear();
+
+private:
+    struct Candidate {
+        float score;
+        uint32_t id;
+    };
+
+    class VisitedPool;
+
+    // 第 0 层邻接表：每个节点 [count, n1 ... n_{2M}]
+    uint32_t* level0_links(uint32_t node) { return &level0_[static_cast<size_t>(node) * (max_links0_ + 1)]; }
+    const uint32_t* level0_links(uint32_t node) const { return &level0_[static_cast<size_t>(node) * (max_links0_ + 1)]; }
+    // 第 level (>=1) 层邻接表：每层 [count, n1 ... n_M]
+    uint32_t* upper_links(uint32_t node, int level) { return &upper_[node][static_cast<size_t>(level - 1) * (max_links_ + 1)]; }
+    const uint32_t* upper_links(uint32_t node, int level) const { return &upper_[node][static_cast<size_t>(level - 1) * (max_links_ + 1)]; }
+    uint32_t* links(uint32_t node, int level) { return level == 0 ? level0_links(node) : upper_links(node, level); }
+    const uint32_t* links(uint32_t node, int level) const { return level == 0 ? level0_links(node) : upper_links(node, level); }
+
+    void configure(const HnswConfig& config);
+    int random_level();
+    void insert(const VectorView& vectors, uint32_t node);
+    uint32_t greedy_descend(const VectorView& vectors, const float* query, uint32_t entry,
+                            int from_level, int to_level) const;
+    std::vector<Candidate> search_layer(const VectorView& vectors, const float* query,
+                                        uint32_t entry, size_t ef, int level) const;
+    std::vector<Candidate> select_neighbors(const VectorView& vectors, std::vector<Candidate>& candidates,
+                                            size_t max_count) const;
+    void connect(const VectorView& vectors, uint32_t node, uint32_t neighbor, int level);
+
+    HnswConfig config_;
+    size_t max_links_;
+    size_t max_links0_;
+    double level_mult_;
+
+    std::vector<uint32_t> level0_;
+    std::vector<std::vector<uint32_t> > upper_;
+    std::vector<int> levels_;
+    uint32_t entry_point_;
+    int max_level_;
+
+    std::mt19937 rng_;
+    std::unique_ptr<VisitedPool> visited_pool_;
+};
+
+#endif // HNSW_INDEX_H
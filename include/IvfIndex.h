@@ -0,0 +1,69 @@
+#ifndef IVF_INDEX_H
+#define IVF_INDEX_H
+
+#include "AlignedAllocator.h"
+#include "TopKHeap.h"
+#include "VectorOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+class BinaryWriter;
+class BinaryReader;
+
+// IVF 索引参数
+struct IvfConfig {
+    int nlist;                  // 聚类中心（倒排列表）个数，<= 0 时取 sqrt(N)
+    int nprobe;                 // 检索时扫描的列表数，越大召回越高、越慢
+    int train_iterations;       // k-means 迭代次数
+    int max_samples_per_list;   // 训练采样上限（每个中心），控制大语料上的训练耗时
+
+    IvfConfig() : nlist(0), nprobe(8), train_iterations(10), max_samples_per_list(64) {}
+};
+
+// 倒排文件（IVF）粗量化索引：k-means 聚类中心 + 每个中心的条目 id 列表
+// 只保存中心与 id，不复制向量；要求向量已 L2 归一化（球面 k-means，按内积分配）
+// 构建与插入需串行调用，检索可并发
+class IvfIndex {
+public:
+    IvfIndex();
+
+    // 在视图的全部行上训练聚类中心并建立倒排列表；pool 非空时并行分配
+    void build(const VectorView& vectors, size_t count, const IvfConfig& config, ThreadPool* pool = nullptr);
+
+    // 追加第 size() 行（向量须已写入视图），分配到最近的中心，不重新训练
+    void add(const VectorView& vectors);
+
+    // 扫描与查询最相似的 nprobe 个列表，返回得分最高的 top_k 个候选（降序）
+    std::vector<TopKHeap::Entry> search(const VectorView& vectors, const float* query,
+                                        size_t top_k, size_t nprobe) const;
+
+    size_t size() const { return count_; }
+    size_t dim() const { return dim_; }
+    bool empty() const { return count_ == 0; }
+    size_t nlist() const { return lists_.size(); }
+    const IvfConfig& config() const { return config_; }
+    size_t get_memory_usage() const;
+
+    // 写入 / 读取索引文件中的一段（由 SimilaritySearch 快照调用），读取失败时清空并返回 false
+    void save(BinaryWriter& out) const;
+    bool load(BinaryReader& in);
+
+    void clear();
+
+private:
+    const float* centroid(size_t index) const { return centroids_.data() + index * stride_; }
+    size_t nearest_centroid(const float* vec, std::vector<float>& scores) const;
+    void assign_rows(const VectorView& vectors, const uint32_t* ids, size_t count,
+                     uint32_t* assignment, ThreadPool* pool) const;
+
+    IvfConfig config_;
+    size_t dim_;
+    size_t stride_;
+    AlignedFloatVector centroids_;              // [nlist, stride_]
+    std::vector<std::vector<uint32_t> > lists_;
+    size_t count_;
+};
+
+#endif // IVF_INDEX_H
@@ -0,0 +1,46 @@
+#ifndef LOG_H
+#define LOG_H
+
+// 日志门面：级别先判断再格式化；低于编译期最低级别 LOG_MIN_LEVEL 的调用整段被编译器删除（参数仍做类型检查）。
+// 输出后端：设置了回调时交给回调，否则 Android 写 logcat，其他平台写 stderr。
+// 用法：在 .cpp 中先 #define LOG_TAG "模块名"，再使用 LOGD / LOGI / LOGW / LOGE
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+// 编译期最低级别，可用 -DLOG_MIN_LEVEL=LOG_LEVEL_WARN 等覆盖；默认去掉 DEBUG 级（逐次推理等热路径日志）
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 回调收到的是格式化后的整条消息
+typedef void (*LogCallback)(int level, const char* tag, const char* message);
+
+// 运行期最低级别（默认 LOG_LEVEL_DEBUG，即只受编译期级别限制）
+void log_set_level(int level);
+bool log_enabled(int level);
+
+// 设置输出回调，传 nullptr 恢复默认后端
+void log_set_callback(LogCallback callback);
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 3, 4)))
+#endif
+void log_write(int level, const char* tag, const char* format, ...);
+
+#define LOG_PRINT(level, tag, ...)                                      \
+    do {                                                                \
+        if ((level) >= LOG_MIN_LEVEL && log_enabled(level)) {           \
+            log_write((level), (tag), __VA_ARGS__);                     \
+        }                                                               \
+    } while (0)
+
+#define LOGD(...) LOG_PRINT(LOG_LEVEL_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) LOG_PRINT(LOG_LEVEL_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) LOG_PRINT(LOG_LEVEL_WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) LOG_PRINT(LOG_LEVEL_ERROR, LOG_TAG, __VA_ARGS__)
+
+#endif // LOG_H
@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件：内容按需由页缓存换入，同一文件被多个进程映射时共享物理页
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool is_open() const { return data_ != nullptr; }
+
+    // 提示内核 [offset, offset + length) 为随机访问：缺页时不再预读相邻页，只换入实际访问的页
+    void advise_random(size_t offset, size_t length) const;
+
+    // 映射范围内当前驻留在物理内存（页缓存）中的字节数，按页统计
+    size_t resident_size() const;
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* data_;
+    size_t size_;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,78 @@
+#ifndef PRODUCT_QUANTIZER_H
+#define PRODUCT_QUANTIZER_H
+
+#include "TopKHeap.h"
+#include "VectorOps.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+class BinaryWriter;
+class BinaryReader;
+
+// 乘积量化参数
+struct PqConfig {
+    int m;                  // 子空间个数，即每条向量的编码字节数；0 表示 dim / 4
+    int train_iterations;   // 每个子空间 k-means 迭代次数
+    int max_train_samples;  // 训练采样条数上限
+
+    PqConfig() : m(0), train_iterations(10), max_train_samples(16384) {}
+};
+
+// 乘积量化（PQ）压缩存储：向量切分为 m 个子空间，每个子空间用 256 个中心的码本量化为 1 字节
+// 检索采用非对称距离计算（ADC）：每个查询先算出 [m, 256] 的子空间内积查找表，
+// 每条记录的估算内积只需 m 次查表相加
+class ProductQuantizer {
+public:
+    static constexpr size_t kCentroids = 256;
+
+    ProductQuantizer();
+
+    // 在视图前 count 行上训练码本并编码全部行
+    void build(const VectorView& vectors, size_t count, const PqConfig& config, ThreadPool* pool = nullptr);
+
+    // 追加一条向量的编码（须已训练）
+    void add(const float* vec);
+
+    // 计算查询的查找表，table 长度为 table_size()
+    void compute_table(const float* query, float* table) const;
+    size_t table_size() const { return m_ * kCentroids; }
+
+    // 用查找表估算 [begin, end) 行的内积，候选写入 heap
+    void scan(const float* table, size_t begin, size_t end, TopKHeap& heap) const;
+
+    size_t size() const { return count_; }
+    size_t dim() const { return dim_; }
+    bool empty() const { return count_ == 0; }
+    size_t code_size() const { return m_; }
+    size_t get_memory_usage() const;
+
+    // 写入 / 读取索引文件中的一段（由 SimilaritySearch 快照调用），读取失败时清空并返回 false
+    void save(BinaryWriter& out) const;
+    bool load(BinaryReader& in);
+
+    void clear();
+
+private:
+    size_t sub_dim(size_t j) const { return offsets_[j + 1] - offsets_[j]; }
+    // 子空间 j 的转置码本 [sub_dim(j), 256]
+    const float* codebook(size_t j) const { return &codebooks_[offsets_[j] * kCentroids]; }
+    float* codebook(size_t j) { return &codebooks_[offsets_[j] * kCentroids]; }
+
+    // 子向量与子空间 j 全部中心的内积，写入 out[256]
+    void subspace_dots(size_t j, const float* sub, float* out) const;
+    void train_subspace(size_t j, const VectorView& vectors, const std::vector<uint32_t>& samples,
+                        int iterations);
+    void encode(const float* vec, uint8_t* code, float* scores) const;
+
+    size_t dim_;
+    size_t m_;
+    std::vector<size_t> offsets_;       // 各子空间起始维度 [m + 1]
+    std::vector<float> codebooks_;      // [dim, 256]，按子空间连续存放
+    std::vector<float> half_norms_;     // 中心平方范数的一半 [m, 256]，用于最近中心判定
+    std::vector<uint8_t> codes_;        // 行主序 [count, m]
+    size_t count_;
+};
+
+#endif // PRODUCT_QUANTIZER_H
@@ -0,0 +1,42 @@
+#ifndef RAW_VECTOR_FILE_H
+#define RAW_VECTOR_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// 定长 float 向量的磁盘存储：每行 dim 个 float 紧密排列，按行号随机读取
+// 用于压缩存储下保留全精度向量做重排，内存中不驻留原始矩阵；文件由调用方指定路径，重新创建时覆盖
+// 读取可并发，追加需串行
+class RawVectorFile {
+public:
+    RawVectorFile();
+    ~RawVectorFile();
+
+    // 创建（截断）文件
+    bool create(const std::string& path, size_t dim);
+
+    // 打开已有文件继续使用（行数由文件大小推出），文件不存在或大小不是整行时失败
+    bool open(const std::string& path, size_t dim);
+
+    bool append(const float* vec);
+
+    // 读取第 index 行到 out[dim]
+    bool read(size_t index, float* out) const;
+
+    size_t size() const { return count_; }
+    size_t dim() const { return dim_; }
+    const std::string& path() const { return path_; }
+
+    void close();
+
+private:
+    RawVectorFile(const RawVectorFile&);
+    RawVectorFile& operator=(const RawVectorFile&);
+
+    int fd_;
+    size_t dim_;
+    size_t count_;
+    std::string path_;
+};
+
+#endif // RAW_VECTOR_FILE_H
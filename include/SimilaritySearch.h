@@ -5,14 +5,47 @@
 #include <string>
 #include <memory>
 #include <utility>
+#include <cstdint>
+#include "HnswIndex.h"
+#include "IvfIndex.h"
+#include "ProductQuantizer.h"
+#include "ScalarQuantizer.h"
+#include "HalfVectorStore.h"
+#include "BinaryCodeStore.h"
 
 struct SearchResult {
     std::string question;
     std::string answer;
     float similarity;
+    int64_t id;         // 条目在索引中的插入序号，无结果时为 -1
     
-    SearchResult(const std::string& q, const std::string& a, float s)
-        : question(q), answer(a), similarity(s) {}
+    SearchResult(const std::string& q, const std::string& a, float s, int64_t i = -1)
+        : question(q), answer(a), similarity(s), id(i) {}
+};
+
+// 相似度度量方式
+enum SimilarityMetric {
+    // 余弦相似度：插入时对向量做 L2 归一化，查询向量每次搜索归一化一次，检索本身只做内积
+    METRIC_COSINE,
+    // 归一化内积：调用方保证入库向量与查询向量均已 L2 归一化（如 W2V/BERT 的输出），不再做任何归一化
+    METRIC_NORMALIZED_INNER_PRODUCT
+};
+
+// optimize() 构建的索引类型
+enum IndexType {
+    INDEX_FLAT,     // 不建索引，始终精确线性扫描
+    INDEX_HNSW,     // HNSW 图索引（近似最近邻）
+    INDEX_IVF       // IVF 倒排索引（k-means 粗量化），构建与更新开销远低于图索引
+};
+
+// 向量存储方式；压缩存储下检索直接扫描编码，不再构建 HNSW / IVF 索引
+enum StorageType {
+    STORAGE_FLOAT32,    // 原始 float 矩阵（默认）
+    STORAGE_PQ,         // 乘积量化编码，检索以查表（ADC）估算内积
+    STORAGE_INT8,       // int8 标量量化，检索用整数 SIMD 点积，内存为 float 的 1/4
+    STORAGE_FP16,       // fp16 存储，内存为 float 的 1/2，精度损失可忽略
+    STORAGE_BF16,       // bf16 存储，内存同 fp16，尾数更短、转换更廉价
+    STORAGE_BINARY      // 符号位二值编码（float 的 1/32）按汉明距离筛选候选，再用原始向量精确重排
 };
 
 class SimilaritySearch {
@@ -20,7 +53,8 @@ public:
     SimilaritySearch();
     ~SimilaritySearch();
     
-    bool initialize(int embedding_dim);
+    // 外部来源、未归一化的向量请使用 METRIC_COSINE
+    bool initialize(int embedding_dim, SimilarityMetric metric = METRIC_COSINE);
     
     bool add_qa(const std::string& question, const std::string& answer, const std::vector<float>& embedding);
     
@@ -28,15 +62,68 @@ public:
                      const std::vector<std::string>& answers,
                      const std::vector<std::vector<float> >& embeddings);
     
+    // 返回最相似的一条（top_k 参数仅为兼容保留，多条结果请使用 search_top_k）
     SearchResult search(const std::vector<float>& query_embedding, int top_k = 1);
     
     std::vector<SearchResult> search_batch(const std::vector<std::vector<float> >& query_embeddings, int top_k = 1);
     
+    // 返回按相似度降序排列的前 top_k 条结果（不足 top_k 时返回全部）
+    std::vector<SearchResult> search_top_k(const std::vector<float>& query_embedding, int top_k);
+    
+    std::vector<std::vector<SearchResult> > search_batch_top_k(const std::vector<std::vector<float> >& query_embeddings, int top_k);
+    
     size_t size() const;
     
+    SimilarityMetric metric() const;
+    
+    // 检索线程数（含调用线程），<= 1 时单线程扫描（默认）
+    void set_num_threads(int num_threads);
+    
+    // 语料条数不低于该值时才启用多线程分片扫描，避免小语料上的调度开销
+    void set_parallel_threshold(size_t min_entries);
+    
+    // 索引类型，默认 INDEX_HNSW；修改后需重新调用 optimize() 生效
+    void set_index_type(IndexType type);
+    
+    // HNSW 参数；M / ef_construction 在下次 optimize() 时生效，ef_search 立即生效
+    void set_hnsw_config(const HnswConfig& config);
+    
+    // IVF 参数；nlist 等训练参数在下次 optimize() 时生效，nprobe 立即生效
+    void set_ivf_config(const IvfConfig& config);
+    
+    // 存储方式，在 optimize() 时生效：压缩存储会训练编码并释放内存中的原始矩阵
+    // （需要重排且未指定文件时保留）；原始矩阵释放后无法切回，需 clear() 后重新加载
+    void set_storage_type(StorageType type);
+    
+    // PQ 参数，在下次压缩时生效
+    void set_pq_config(const PqConfig& config);
+    
+    // 压缩存储下的精确重排：先按压缩得分取前 max(top_k, candidates) 条，再用原始向量重新打分；
+    // raw_vector_path 非空时原始向量写入该文件并按需读取，为空时保留在内存中；candidates 为 0 时不重排
+    // candidates 立即生效，文件路径在下次压缩时生效；STORAGE_BINARY 始终重排，candidates 为 0 时取 256
+    void set_rerank(size_t candidates, const std::string& raw_vector_path = "");
+    
+    // 条数低于该值时 optimize() 不建索引，检索仍走精确扫描
+    void set_ann_threshold(size_t min_entries);
+    
     void clear();
     
+    // 按当前存储方式压缩、按索引类型为已有数据构建索引，之后 search / search_batch 自动使用；
+    // 之后再 add_qa 的条目会增量编码 / 插入索引
     void optimize();
+    
+    // 保存索引快照（文本、向量或压缩编码、已构建的近似索引），key 为调用方的数据指纹
+    // （如模型与语料的哈希）；压缩存储下原始矩阵已释放时不含原始向量，重排仍依赖 set_rerank 指定的文件
+    bool save(const std::string& path, uint64_t key = 0) const;
+    
+    // 载入快照，恢复度量、索引类型与存储方式，替换当前全部数据；文件不存在、版本或 key 不匹配时
+    // 返回 false 且不改动当前数据。线程数、检索参数与重排设置沿用当前值，应在载入前设置
+    bool load(const std::string& path, uint64_t key = 0);
+    
+    // 以只读映射方式载入快照：文本与原始矩阵直接在映射的文件上读取，不做反序列化，载入耗时与语料规模无关，
+    // 同机多个进程映射同一文件时共享页缓存中的一份数据（近似索引与压缩编码仍复制到内存）。
+    // 映射期间快照文件不可被截断改写（save 以临时文件加原子替换写入）；之后 add_qa / optimize 时先复制到内存
+    bool load_mapped(const std::string& path, uint64_t key = 0);
 
 private:
     class Impl;
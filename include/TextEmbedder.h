@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include "HalfFloat.h"
+
+struct BertInputConfig;
 
 class TextEmbedder {
 public:
@@ -16,15 +19,24 @@ public:
     TextEmbedder();
     ~TextEmbedder();
     
-    bool initialize(const std::string& model_path, ModelType type = MODEL_AUTO);
+    // precision 仅对 Word2Vec 词向量表生效
+    bool initialize(const std::string& model_path, ModelType type = MODEL_AUTO,
+                    VectorPrecision precision = PRECISION_FLOAT32);
     
     // 对于 BERT，可能需要额外的配置，如词表路径
     bool initialize_bert(const std::string& model_path, const std::string& vocab_path);
     
     std::vector<float> embed(const std::string& text);
     
+    // BERT 按批打包推理，Word2Vec 逐条计算
     std::vector<std::vector<float> > embed_batch(const std::vector<std::string>& texts);
     
+    // BERT 单次推理的最大条数（默认 32），可在初始化前后设置；对 Word2Vec 无效
+    void set_max_batch_size(size_t max_batch_size);
+    
+    // BERT 模型输入节点名映射（见 BertInputConfig），需在初始化前设置；对 Word2Vec 无效
+    void set_bert_input_config(const BertInputConfig& config);
+    
     int get_embedding_dim() const;
     
     size_t get_memory_usage() const;
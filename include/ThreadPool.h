@@ -0,0 +1,35 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的线程池，供检索分片扫描等数据并行场景使用
+// 可被多个线程同时调用 parallel_for
+class ThreadPool {
+public:
+    // num_threads 为后台工作线程数（调用线程也会参与计算）
+    explicit ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    size_t num_threads() const { return workers_.size(); }
+
+    // 并行执行 fn(0) ... fn(count - 1)，返回时全部任务已完成
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()> > tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_;
+};
+
+#endif // THREAD_POOL_H
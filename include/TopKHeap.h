@@ -0,0 +1,79 @@
+#ifndef TOP_K_HEAP_H
+#define TOP_K_HEAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// 有界小顶堆：扫描过程中只保留得分最高的 k 个候选，复杂度 O(N log k)，无需对全量结果排序
+// 得分相同时 id 较小者优先，与线性扫描"先到先得"的语义一致
+class TopKHeap {
+public:
+    struct Entry {
+        float score;
+        size_t id;
+    };
+
+    explicit TopKHeap(size_t k = 1) : k_(k) {
+        heap_.reserve(k);
+    }
+
+    void reset(size_t k) {
+        k_ = k;
+        heap_.clear();
+        heap_.reserve(k);
+    }
+
+    size_t capacity() const { return k_; }
+    size_t size() const { return heap_.size(); }
+    bool full() const { return heap_.size() >= k_; }
+
+    // 当前入堆门槛：堆满时为堆中最低分，否则为 -inf
+    float threshold() const {
+        return full() && !heap_.empty() ? heap_.front().score : -std::numeric_limits<float>::infinity();
+    }
+
+    // 返回是否入堆
+    bool push(float score, size_t id) {
+        if (k_ == 0) return false;
+        Entry entry = { score, id };
+        if (heap_.size() < k_) {
+            heap_.push_back(entry);
+            std::push_heap(heap_.begin(), heap_.end(), better);
+            return true;
+        }
+        if (!better(entry, heap_.front())) return false;
+        std::pop_heap(heap_.begin(), heap_.end(), better);
+        heap_.back() = entry;
+        std::push_heap(heap_.begin(), heap_.end(), better);
+        return true;
+    }
+
+    // 合并另一个堆（例如分片扫描的局部结果）
+    void merge(const TopKHeap& other) {
+        for (size_t i = 0; i < other.heap_.size(); ++i) {
+            push(other.heap_[i].score, other.heap_[i].id);
+        }
+    }
+
+    // 取出按得分降序排列的结果，堆被清空
+    std::vector<Entry> take_sorted() {
+        std::vector<Entry> result;
+        result.swap(heap_);
+        std::sort_heap(result.begin(), result.end(), better);
+        heap_.reserve(k_);
+        return result;
+    }
+
+private:
+    // 以 better 作为比较器时，堆顶是当前最差的候选
+    static bool better(const Entry& a, const Entry& b) {
+        return a.score > b.score || (a.score == b.score && a.id < b.id);
+    }
+
+    std::vector<Entry> heap_;
+    size_t k_;
+};
+
+#endif // TOP_K_HEAP_H
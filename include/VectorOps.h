@@ -0,0 +1,76 @@
+#ifndef VECTOR_OPS_H
+#define VECTOR_OPS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "HalfFloat.h"
+
+// 行主序向量矩阵的只读视图；矩阵由调用方持有，扩容后需重新传入
+struct VectorView {
+    const float* data;
+    size_t stride;          // 行间距（float 个数）
+    size_t dim;
+
+    const float* row(size_t index) const { return data + index * stride; }
+};
+
+// 向量运算内核（点积 / 范数 / 归一化）
+// 首次调用时根据 CPU 特性选择实现：x86 上 AVX-512 > AVX2+FMA > SSE，ARM 上 NEON，否则标量
+class VectorOps {
+public:
+    // 点积 sum(a[i] * b[i])
+    static float dot(const float* a, const float* b, size_t n);
+
+    // 查询向量与 count 行矩阵逐行点积，行间距为 stride 个 float，结果写入 out[count]
+    static void dot_rows(const float* query, const float* rows, size_t stride,
+                         size_t count, size_t n, float* out);
+
+    // 分块点积（小规模 GEMM）：out[i * out_stride + r] = dot(queries[i], rows[r])
+    // 每 4 个查询共享一次行加载，用于批量查询时提高矩阵数据的复用率
+    static void dot_block(const float* queries, size_t query_stride, size_t query_count,
+                          const float* rows, size_t row_stride, size_t row_count,
+                          size_t n, float* out, size_t out_stride);
+
+    // 平方范数 sum(a[i] * a[i])
+    static float squared_norm(const float* a, size_t n);
+
+    // v *= factor
+    static void scale(float* v, size_t n, float factor);
+
+    // L2 归一化，范数不大于 eps 时保持原样；返回归一化前的范数
+    static float l2_normalize(float* v, size_t n, float eps = 1e-6f);
+
+    // 当前选用的内核名称（"avx512" / "avx2" / "sse" / "neon" / "scalar"）
+    static const char* kernel_name();
+
+    // int8 点积，分量须在 [-127, 127] 内（-128 会使 x86 内核结果错误）
+    // x86 上 AVX-512 VNNI > AVX-VNNI > AVX2 > SSSE3，ARM 上 NEON（编译时开启 dotprod 则用 SDOT），否则标量
+    static int32_t dot_i8(const int8_t* a, const int8_t* b, size_t n);
+
+    // int8 查询与 count 行 int8 矩阵逐行点积，行间距为 stride 字节，结果写入 out[count]
+    static void dot_rows_i8(const int8_t* query, const int8_t* rows, size_t stride,
+                            size_t count, size_t n, int32_t* out);
+
+    // 当前选用的 int8 内核名称
+    static const char* int8_kernel_name();
+
+    // float 查询与半精度向量的点积，半精度数据在寄存器内转换为 float
+    // x86 上需 AVX2 + F16C，aarch64 上用 NEON，否则标量
+    static float dot_half(const float* query, const uint16_t* row, size_t n, HalfType type);
+
+    // float 查询与 count 行半精度矩阵逐行点积，行间距为 stride 个元素
+    static void dot_rows_half(const float* query, const uint16_t* rows, size_t stride,
+                              size_t count, size_t n, HalfType type, float* out);
+
+    // acc += v（v 为半精度），用于词向量求和
+    static void accumulate_half(float* acc, const uint16_t* v, size_t n, HalfType type);
+
+    // 当前选用的半精度内核名称
+    static const char* half_kernel_name();
+
+    // 二值编码与 count 行连续存放的编码（每行 words 个 64 位字）逐行求汉明距离，结果写入 out[count]
+    static void hamming_rows(const uint64_t* query, const uint64_t* rows, size_t words,
+                             size_t count, uint32_t* out);
+};
+
+#endif // VECTOR_OPS_H
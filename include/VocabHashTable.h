@@ -0,0 +1,58 @@
+#ifndef VOCAB_HASH_TABLE_H
+#define VOCAB_HASH_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 词表哈希：开放寻址（线性探测）的扁平表，槽位只存 (行号, 哈希值)，词的字节统一存放在一块字符串区中。
+// 行号按插入顺序从 0 递增，可直接作为词向量矩阵的行号；查找接受 string_view，无需构造临时字符串
+class VocabHashTable {
+public:
+    static const uint32_t kNotFound = 0xffffffffu;
+
+    VocabHashTable();
+
+    // 预留 count 个词的空间，避免加载过程中反复扩容
+    void reserve(size_t count);
+
+    // 插入词，返回 (行号, 是否为新词)；已存在时返回原有行号
+    std::pair<uint32_t, bool> insert(std::string_view word);
+
+    // 同上，hash 须为 hash_word(word)：批量加载时可在多个线程中预先计算哈希，插入本身仍须串行
+    std::pair<uint32_t, bool> insert(std::string_view word, uint32_t hash);
+
+    static uint32_t hash_word(std::string_view word);
+
+    // 返回行号，不存在时返回 kNotFound
+    uint32_t find(std::string_view word) const;
+
+    std::string_view word(uint32_t row) const {
+        return std::string_view(arena_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]);
+    }
+
+    size_t size() const { return offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+    size_t get_memory_usage() const;
+
+    void clear();
+
+private:
+    struct Slot {
+        uint32_t row;       // kNotFound 表示空槽
+        uint32_t hash;      // 探测时先比较哈希，命中后再比较字节
+    };
+
+    void rehash(size_t capacity);
+    // 查找 word 所在槽位，不存在时返回应插入的空槽
+    size_t probe(std::string_view word, uint32_t hash) const;
+
+    std::vector<Slot> slots_;           // 容量为 2 的幂
+    std::string arena_;                 // 全部词的字节
+    std::vector<uint64_t> offsets_;     // 第 i 个词为 arena_[offsets_[i], offsets_[i + 1])
+};
+
+#endif // VOCAB_HASH_TABLE_H
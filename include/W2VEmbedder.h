@@ -3,25 +3,61 @@
 
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include "HalfFloat.h"
+#include "MappedFile.h"
+#include "VocabHashTable.h"
+#include "DoubleArrayTrie.h"
 
 class W2VEmbedder {
 public:
     W2VEmbedder();
-    bool initialize(const std::string& model_path);
+    // precision 为词向量表的存储精度：半精度词表内存减半，求和时在寄存器内转换为 float。
+    // 模型为二进制词表格式（scripts/convert_w2v.py 生成）时直接映射文件，精度由文件决定，precision 被忽略；
+    // 此时启动只读取词表，词向量按行在首次使用时换入，内存紧张时由系统回收，适合大词表部署在小内存环境
+    bool initialize(const std::string& model_path, VectorPrecision precision = PRECISION_FLOAT32);
     std::vector<float> embed(const std::string& text);
     int get_embedding_dim() const { return embedding_dim_; }
+    // 映射的二进制词表按实际驻留的页计入
     size_t get_memory_usage() const;
     bool is_initialized() const { return initialized_; }
 
 private:
-    std::unordered_map<std::string, std::vector<float> > word_vectors_;
+    // 词 -> 词向量表行号；词向量按行连续存放在 vectors_（float）或 half_vectors_（半精度）中
+    VocabHashTable vocab_;
+    std::vector<float> vectors_;
+    std::vector<uint16_t> half_vectors_;
+    VectorPrecision precision_;
     int embedding_dim_;
-    int max_word_len_;
     bool initialized_;
-    std::vector<float> zero_vector_;
     
-    std::vector<std::string> tokenize_chinese(const std::string& text);
+    // 二进制词表格式：词按字节序排序存放（二分查找），词向量矩阵行号与词序一致，均直接在映射的文件上读取
+    std::unique_ptr<MappedFile> mapped_;
+    const uint64_t* mapped_word_offsets_;   // [vocab_size + 1]
+    const char* mapped_words_;
+    size_t mapped_vocab_size_;
+    // 当前词向量矩阵（指向 vectors_ / half_vectors_ 或映射的文件）
+    const float* float_rows_;
+    const uint16_t* half_rows_;
+    // 词表编译成的 Trie（值为行号），分词时做正向最大匹配
+    DoubleArrayTrie trie_;
+    
+    // 正向最大匹配分词，按顺序对每个词表中的词调用 visit(行号)；不在词表中的片段直接跳过
+    template <typename Visitor>
+    void for_each_word(std::string_view text, Visitor&& visit) const;
+    bool load_binary_model(const std::string& model_path);
+    // 无文件头的文本格式（每行 `word v1 ... vD`）：映射文件后按行边界切块，多线程解析
+    bool load_text_model(const std::string& model_path);
+    // 构建 Trie 并标记初始化完成
+    void finish_load();
+    void reset();
+    // 查找词的行号，不在词表中时返回 false
+    bool find_word(std::string_view word, uint32_t& index) const;
+    void add_word(const std::string& word, const float* vec);
+    // acc += 第 index 个词向量
+    void accumulate(uint32_t index, float* acc) const;
 };
 
 #endif // W2V_EMBEDDER_H
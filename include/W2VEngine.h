@@ -3,34 +3,57 @@
 
 #include "TextEmbedder.h"
 #include "SimilaritySearch.h"
+#include "BinaryIO.h"
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <sys/stat.h>
 
 class W2VEngine {
 public:
-    W2VEngine() : embedder_(new TextEmbedder()), searcher_(new SimilaritySearch()) {}
+    W2VEngine() : embedder_(new TextEmbedder()), searcher_(new SimilaritySearch()), model_fingerprint_(0) {}
 
-    bool initialize(const std::string& model_path) {
-        return embedder_->initialize(model_path);
+    // precision 为 Word2Vec 词向量表的存储精度，PRECISION_FP16 / PRECISION_BF16 可使词表内存减半
+    bool initialize(const std::string& model_path, VectorPrecision precision = PRECISION_FLOAT32) {
+        if (!embedder_->initialize(model_path, TextEmbedder::MODEL_AUTO, precision)) return false;
+        int32_t precision_value = precision;
+        model_fingerprint_ = fnv1a64(&precision_value, sizeof(precision_value), file_fingerprint(model_path));
+        return true;
     }
 
     bool initialize_bert(const std::string& model_path, const std::string& vocab_path) {
-        return embedder_->initialize_bert(model_path, vocab_path);
+        if (!embedder_->initialize_bert(model_path, vocab_path)) return false;
+        model_fingerprint_ = file_fingerprint(vocab_path, file_fingerprint(model_path));
+        return true;
     }
 
-    bool load_qa_from_file(const std::string& file_path) {
+    // snapshot_path 非空时使用索引快照：快照由同一模型与同一问答文件生成时直接载入，跳过向量计算；
+    // 否则重新计算并写入快照（写入失败不影响本次加载）。快照以只读映射方式载入，同机多个进程共享其中的文本与向量
+    bool load_qa_from_file(const std::string& file_path, const std::string& snapshot_path = "") {
         if (!embedder_->is_initialized()) return false;
-        if (!searcher_->initialize(embedder_->get_embedding_dim())) return false;
+        if (!init_searcher()) return false;
 
-        std::ifstream file(file_path);
+        std::ifstream file(file_path, std::ios::binary);
         if (!file.is_open()) return false;
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string content = buffer.str();
 
+        uint64_t key = 0;
+        if (!snapshot_path.empty()) {
+            int32_t dim = embedder_->get_embedding_dim();
+            key = fnv1a64(content.data(), content.size(), fnv1a64(&dim, sizeof(dim), model_fingerprint_));
+            if (searcher_->load_mapped(snapshot_path, key)) return true;
+        }
+
+        std::istringstream lines(content);
         std::string line;
         std::vector<std::string> questions, answers;
-        while (std::getline(file, line)) {
+        while (std::getline(lines, line)) {
             if (line.empty()) continue;
             size_t pos = line.find(',');
             if (pos != std::string::npos) {
@@ -42,15 +65,20 @@ public:
         if (questions.empty()) return true;
 
         auto embeddings = embedder_->embed_batch(questions);
-        return searcher_->add_qa_batch(questions, answers, embeddings);
+        if (!searcher_->add_qa_batch(questions, answers, embeddings)) return false;
+        searcher_->optimize();
+        if (!snapshot_path.empty()) searcher_->save(snapshot_path, key);
+        return true;
     }
 
     bool load_qa_from_memory(const std::vector<std::string>& questions, const std::vector<std::string>& answers) {
         if (!embedder_->is_initialized()) return false;
-        if (!searcher_->initialize(embedder_->get_embedding_dim())) return false;
+        if (!init_searcher()) return false;
         
         auto embeddings = embedder_->embed_batch(questions);
-        return searcher_->add_qa_batch(questions, answers, embeddings);
+        if (!searcher_->add_qa_batch(questions, answers, embeddings)) return false;
+        searcher_->optimize();
+        return true;
     }
 
     std::pair<std::string, std::string> search(const std::string& query, float* similarity) {
@@ -74,14 +102,62 @@ public:
         return final_results;
     }
 
+    // 返回按相似度降序排列的前 top_k 条结果，包含条目 id 与得分
+    std::vector<SearchResult> search_top_k(const std::string& query, int top_k) {
+        auto embedding = embedder_->embed(query);
+        return searcher_->search_top_k(embedding, top_k);
+    }
+
+    std::vector<std::vector<SearchResult> > search_batch_top_k(const std::vector<std::string>& queries, int top_k) {
+        auto embeddings = embedder_->embed_batch(queries);
+        return searcher_->search_batch_top_k(embeddings, top_k);
+    }
+
+    // 检索线程数（含调用线程）；语料条数低于 min_parallel_entries 时仍单线程扫描
+    void set_search_threads(int num_threads, size_t min_parallel_entries = 20000) {
+        searcher_->set_num_threads(num_threads);
+        searcher_->set_parallel_threshold(min_parallel_entries);
+    }
+
     size_t get_qa_count() const { return searcher_->size(); }
     int get_embedding_dim() const { return embedder_->get_embedding_dim(); }
     size_t get_memory_usage() const { return embedder_->get_memory_usage(); }
     void release() { embedder_->release(); searcher_->clear(); }
 
 private:
+    // W2V 与 BERT 的输出均已 L2 归一化，检索直接按内积计算
+    bool init_searcher() {
+        return searcher_->initialize(embedder_->get_embedding_dim(), METRIC_NORMALIZED_INNER_PRODUCT);
+    }
+
+    // 模型文件指纹：inode、修改时间、文件大小与首尾各 1MB 内容的哈希，避免每次启动读完整个模型。
+    // 首尾采样无法发现同尺寸的原地修改（如只改动中间行的词向量），因此 inode 与修改时间也参与哈希：
+    // 模型被替换或改写后快照即失效（复制、touch 等未改内容的操作也会使快照重建一次）
+    static uint64_t file_fingerprint(const std::string& path, uint64_t seed = 14695981039346656037ull) {
+        const std::streamoff kChunk = 1 << 20;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return seed;
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return seed;
+        uint64_t identity[2] = { static_cast<uint64_t>(st.st_ino), static_cast<uint64_t>(st.st_mtime) };
+        std::streamoff size = file.tellg();
+        uint64_t hash = fnv1a64(identity, sizeof(identity), seed);
+        hash = fnv1a64(&size, sizeof(size), hash);
+        std::vector<char> chunk(static_cast<size_t>(std::min(size, kChunk)));
+        file.seekg(0);
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        hash = fnv1a64(chunk.data(), chunk.size(), hash);
+        if (size > kChunk) {
+            file.seekg(size - static_cast<std::streamoff>(chunk.size()));
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            hash = fnv1a64(chunk.data(), chunk.size(), hash);
+        }
+        return hash;
+    }
+
     std::unique_ptr<TextEmbedder> embedder_;
     std::unique_ptr<SimilaritySearch> searcher_;
+    uint64_t model_fingerprint_;    // 模型（及词表）指纹，参与索引快照的 key
 };
 
 #endif
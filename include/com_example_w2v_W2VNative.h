@@ -23,6 +23,14 @@ JNIEXPORT jlong JNICALL Java_com_example_w2v_W2VNative_initEngine
 JNIEXPORT jboolean JNICALL Java_com_example_w2v_W2VNative_loadQAFromFile
   (JNIEnv *, jclass, jlong, jstring);
 
+/*
+ * Class:     com_example_w2v_W2VNative
+ * Method:    loadQAFromFileCached
+ * Signature: (JLjava/lang/String;Ljava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_example_w2v_W2VNative_loadQAFromFileCached
+  (JNIEnv *, jclass, jlong, jstring, jstring);
+
 /*
  * Class:     com_example_w2v_W2VNative
  * Method:    loadQAFromMemory
@@ -47,6 +55,22 @@ JNIEXPORT jobject JNICALL Java_com_example_w2v_W2VNative_search
 JNIEXPORT jobjectArray JNICALL Java_com_example_w2v_W2VNative_searchBatch
   (JNIEnv *, jclass, jlong, jobjectArray);
 
+/*
+ * Class:     com_example_w2v_W2VNative
+ * Method:    searchTopK
+ * Signature: (JLjava/lang/String;I)[Lcom/example/w2v/W2VNative$SearchResult;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_example_w2v_W2VNative_searchTopK
+  (JNIEnv *, jclass, jlong, jstring, jint);
+
+/*
+ * Class:     com_example_w2v_W2VNative
+ * Method:    searchBatchTopK
+ * Signature: (J[Ljava/lang/String;I)[[Lcom/example/w2v/W2VNative$SearchResult;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_example_w2v_W2VNative_searchBatchTopK
+  (JNIEnv *, jclass, jlong, jobjectArray, jint);
+
 /*
  * Class:     com_example_w2v_W2VNative
  * Method:    getQACount
@@ -9,23 +9,42 @@ public class W2VNative {
         public String question;
         public String answer;
         public float score;
+        public int id;
 
         public SearchResult(String question, String answer, float score) {
+            this(question, answer, score, -1);
+        }
+
+        public SearchResult(String question, String answer, float score, int id) {
             this.question = question;
             this.answer = answer;
             this.score = score;
+            this.id = id;
         }
     }
 
     public static native long initEngine(String modelPath);
     
     public static native boolean loadQAFromFile(long enginePtr, String filePath);
+
+    /**
+     * 加载问答文件并使用索引快照：快照与当前模型和问答文件匹配时直接载入，
+     * 否则重新计算向量并写入 snapshotPath
+     */
+    public static native boolean loadQAFromFileCached(long enginePtr, String filePath, String snapshotPath);
     
     public static native boolean loadQAFromMemory(long enginePtr, String[] questions, String[] answers);
     
     public static native SearchResult search(long enginePtr, String query);
     
     public static native SearchResult[] searchBatch(long enginePtr, String[] queries);
+
+    /**
+     * 返回按相似度降序排列的前 topK 条结果
+     */
+    public static native SearchResult[] searchTopK(long enginePtr, String query, int topK);
+
+    public static native SearchResult[][] searchBatchTopK(long enginePtr, String[] queries, int topK);
     
     public static native int getQACount(long enginePtr);
     
@@ -5,16 +5,8 @@
 #include <memory>
 #include <unordered_map>
 
-#ifdef ANDROID
-#include <android/log.h>
-#define TAG "W2VNative_JNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
-#else
-#include <iostream>
-#define LOGI(...) printf(__VA_ARGS__); printf("\n")
-#define LOGE(...) fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n")
-#endif
+#define LOG_TAG "W2VNative_JNI"
+#include "../include/Log.h"
 
 // 全局引擎映射
 std::unordered_map<jlong, std::shared_ptr<W2VEngine> > engine_map;
@@ -76,6 +68,13 @@ jboolean native_loadQAFromFile(JNIEnv *env, jclass clazz, jlong enginePtr, jstri
     return it->second->load_qa_from_file(jstring_to_string(env, filePath)) ? JNI_TRUE : JNI_FALSE;
 }
 
+jboolean native_loadQAFromFileCached(JNIEnv *env, jclass clazz, jlong enginePtr, jstring filePath, jstring snapshotPath) {
+    auto it = engine_map.find(enginePtr);
+    if (it == engine_map.end()) return JNI_FALSE;
+    return it->second->load_qa_from_file(jstring_to_string(env, filePath), jstring_to_string(env, snapshotPath))
+        ? JNI_TRUE : JNI_FALSE;
+}
+
 jboolean native_loadQAFromMemory(JNIEnv *env, jclass clazz, jlong enginePtr, jobjectArray questions, jobjectArray answers) {
     auto it = engine_map.find(enginePtr);
     if (it == engine_map.end()) return JNI_FALSE;
@@ -87,46 +86,81 @@ jboolean native_loadQAFromMemory(JNIEnv *env, jclass clazz, jlong enginePtr, job
 
 // 缓存 SearchResult 类信息
 static jclass gResultClass = nullptr;
+static jclass gResultArrayClass = nullptr;
 static jmethodID gResultInit = nullptr;
 
+jobject new_result_object(JNIEnv *env, const SearchResult& result) {
+    jstring jq = string_to_jstring(env, result.question);
+    jstring ja = string_to_jstring(env, result.answer);
+    jobject jobj = env->NewObject(gResultClass, gResultInit, jq, ja, result.similarity, (jint)result.id);
+    env->DeleteLocalRef(jq);
+    env->DeleteLocalRef(ja);
+    return jobj;
+}
+
+jobjectArray new_result_array(JNIEnv *env, const std::vector<SearchResult>& results) {
+    jobjectArray jarray = env->NewObjectArray(results.size(), gResultClass, nullptr);
+    for (size_t i = 0; i < results.size(); i++) {
+        jobject jobj = new_result_object(env, results[i]);
+        env->SetObjectArrayElement(jarray, i, jobj);
+        env->DeleteLocalRef(jobj);
+    }
+    return jarray;
+}
+
 jobject native_search(JNIEnv *env, jclass clazz, jlong enginePtr, jstring query) {
     auto it = engine_map.find(enginePtr);
     if (it == engine_map.end()) return nullptr;
-    float similarity = 0.0f;
-    auto result = it->second->search(jstring_to_string(env, query), &similarity);
+    auto results = it->second->search_top_k(jstring_to_string(env, query), 1);
     
     if (!gResultClass || !gResultInit) return nullptr;
     
-    jstring jq = string_to_jstring(env, result.first);
-    jstring ja = string_to_jstring(env, result.second);
-    jobject jobj = env->NewObject(gResultClass, gResultInit, jq, ja, similarity);
-    env->DeleteLocalRef(jq);
-    env->DeleteLocalRef(ja);
-    return jobj;
+    return new_result_object(env, results.empty() ? SearchResult("", "", 0.0f) : results[0]);
 }
 
 jobjectArray native_searchBatch(JNIEnv *env, jclass clazz, jlong enginePtr, jobjectArray queries) {
     auto it = engine_map.find(enginePtr);
     if (it == engine_map.end()) return nullptr;
     std::vector<std::string> q_vec = jobjectarray_to_stringvector(env, queries);
-    std::vector<float> sims;
-    auto results = it->second->search_batch(q_vec, &sims);
+    auto results = it->second->search_batch_top_k(q_vec, 1);
     
     if (!gResultClass || !gResultInit) return nullptr;
     jobjectArray jarray = env->NewObjectArray(results.size(), gResultClass, nullptr);
     
     for (size_t i = 0; i < results.size(); i++) {
-        jstring jq = string_to_jstring(env, results[i].first);
-        jstring ja = string_to_jstring(env, results[i].second);
-        jobject jobj = env->NewObject(gResultClass, gResultInit, jq, ja, sims[i]);
+        jobject jobj = new_result_object(env, results[i].empty() ? SearchResult("", "", 0.0f) : results[i][0]);
         env->SetObjectArrayElement(jarray, i, jobj);
-        env->DeleteLocalRef(jq);
-        env->DeleteLocalRef(ja);
         env->DeleteLocalRef(jobj);
     }
     return jarray;
 }
 
+jobjectArray native_searchTopK(JNIEnv *env, jclass clazz, jlong enginePtr, jstring query, jint topK) {
+    auto it = engine_map.find(enginePtr);
+    if (it == engine_map.end()) return nullptr;
+    auto results = it->second->search_top_k(jstring_to_string(env, query), topK);
+    
+    if (!gResultClass || !gResultInit) return nullptr;
+    return new_result_array(env, results);
+}
+
+jobjectArray native_searchBatchTopK(JNIEnv *env, jclass clazz, jlong enginePtr, jobjectArray queries, jint topK) {
+    auto it = engine_map.find(enginePtr);
+    if (it == engine_map.end()) return nullptr;
+    std::vector<std::string> q_vec = jobjectarray_to_stringvector(env, queries);
+    auto results = it->second->search_batch_top_k(q_vec, topK);
+    
+    if (!gResultClass || !gResultInit || !gResultArrayClass) return nullptr;
+    jobjectArray jarray = env->NewObjectArray(results.size(), gResultArrayClass, nullptr);
+    
+    for (size_t i = 0; i < results.size(); i++) {
+        jobjectArray row = new_result_array(env, results[i]);
+        env->SetObjectArrayElement(jarray, i, row);
+        env->DeleteLocalRef(row);
+    }
+    return jarray;
+}
+
 jint native_getQACount(JNIEnv *env, jclass clazz, jlong enginePtr) {
     auto it = engine_map.find(enginePtr);
     return (it != engine_map.end()) ? (jint)it->second->get_qa_count() : 0;
@@ -161,12 +195,17 @@ static JNINativeMethod gMethods[] = {
     {"getQACount", "(J)I", (void*)native_getQACount},
     {"getEmbeddingDim", "(J)I", (void*)native_getEmbeddingDim},
     {"getMemoryUsage", "(J)J", (void*)native_getMemoryUsage},
-    {"releaseEngine", "(J)V", (void*)native_releaseEngine}
+    {"releaseEngine", "(J)V", (void*)native_releaseEngine},
+    {"searchTopK", nullptr, (void*)native_searchTopK},
+    {"searchBatchTopK", nullptr, (void*)native_searchBatchTopK},
+    {"loadQAFromFileCached", "(JLjava/lang/String;Ljava/lang/String;)Z", (void*)native_loadQAFromFileCached}
 };
 
 // 存储动态生成的签名，防止被释放
 static std::string gSearchSig;
 static std::string gSearchBatchSig;
+static std::string gSearchTopKSig;
+static std::string gSearchBatchTopKSig;
 
 // 为了支持不同的包名，可以在编译时通过 -DJNI_CLASS_NAME="path/to/Class" 来指定
 // 如果未指定，则使用默认值
@@ -192,15 +231,24 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
     // 动态构建签名以支持自定义包名
     gSearchSig = "(JLjava/lang/String;)L" + std::string(className) + "$SearchResult;";
     gSearchBatchSig = "(J[Ljava/lang/String;)[L" + std::string(className) + "$SearchResult;";
+    gSearchTopKSig = "(JLjava/lang/String;I)[L" + std::string(className) + "$SearchResult;";
+    gSearchBatchTopKSig = "(J[Ljava/lang/String;I)[[L" + std::string(className) + "$SearchResult;";
     gMethods[4].signature = (char*)gSearchSig.c_str();
     gMethods[5].signature = (char*)gSearchBatchSig.c_str();
+    gMethods[10].signature = (char*)gSearchTopKSig.c_str();
+    gMethods[11].signature = (char*)gSearchBatchTopKSig.c_str();
 
     // 缓存内部类 SearchResult 信息
     std::string resultClassName = std::string(className) + "$SearchResult";
     jclass resClass = env->FindClass(resultClassName.c_str());
     if (resClass) {
         gResultClass = (jclass)env->NewGlobalRef(resClass);
-        gResultInit = env->GetMethodID(gResultClass, "<init>", "(Ljava/lang/String;Ljava/lang/String;F)V");
+        gResultInit = env->GetMethodID(gResultClass, "<init>", "(Ljava/lang/String;Ljava/lang/String;FI)V");
+    }
+    std::string resultArrayClassName = "[L" + resultClassName + ";";
+    jclass resArrayClass = env->FindClass(resultArrayClassName.c_str());
+    if (resArrayClass) {
+        gResultArrayClass = (jclass)env->NewGlobalRef(resArrayClass);
     }
 
     if (env->RegisterNatives(clazz, gMethods, sizeof(gMethods) / sizeof(gMethods[0])) < 0) {
@@ -216,5 +264,6 @@ JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
     JNIEnv* env = nullptr;
     if (vm->GetEnv((void**)&env, JNI_VERSION_1_6) == JNI_OK) {
         if (gResultClass) env->DeleteGlobalRef(gResultClass);
+        if (gResultArrayClass) env->DeleteGlobalRef(gResultArrayClass);
     }
 }
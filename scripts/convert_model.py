@@ -46,10 +46,11 @@ def convert_to_onnx(model_id, output_dir):
                       output_path,
                       input_names=input_names,
                       output_names=output_names,
+                      # 序列长度也导出为动态维，推理时按实际 token 数（取整到分桶长度）运行
                       dynamic_axes={
-                          'input_ids': {0: 'batch_size'},
-                          'attention_mask': {0: 'batch_size'},
-                          'token_type_ids': {0: 'batch_size'},
+                          'input_ids': {0: 'batch_size', 1: 'sequence'},
+                          'attention_mask': {0: 'batch_size', 1: 'sequence'},
+                          'token_type_ids': {0: 'batch_size', 1: 'sequence'},
                           'output': {0: 'batch_size'}
                       },
                       opset_version=14)
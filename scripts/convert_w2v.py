@@ -0,0 +1,187 @@
+"""将 word2vec 词向量转换为 W2VEmbedder 可直接映射的二进制词表格式。
+
+支持的输入格式：
+  - text  ：每行 `word v1 v2 ... vD`，首行可选 `vocab_size dim` 头（腾讯 AILab 的 .txt 即为此格式）
+  - binary：word2vec 二进制格式，首行 `vocab_size dim`，之后每条为 `word` + 空格 + D 个 float32
+
+输出格式（小端）：
+  - 64 字节文件头：magic "W2VBIN\\0\\0"、version、dim、vocab_size、dtype、max_word_len、
+    词表偏移、矩阵偏移
+  - 词表：u64 偏移数组 [vocab_size + 1] + 连续的 UTF-8 字符数据，词按字节序升序排列（加载端二分查找）
+  - 词向量矩阵：[vocab_size, dim]，行号与词序一致，起始位置按 64 字节对齐
+
+用法：
+  python scripts/convert_w2v.py input.txt output.w2vb --dtype fp16
+"""
+
+import argparse
+import struct
+import sys
+from array import array
+
+MAGIC = b"W2VBIN\0\0"
+VERSION = 1
+HEADER_SIZE = 64
+MATRIX_ALIGN = 64
+DTYPES = {"float32": 0, "fp16": 1, "bf16": 2}
+
+
+def parse_header(line):
+    parts = line.split()
+    if len(parts) == 2 and all(p.isdigit() for p in parts):
+        return int(parts[0]), int(parts[1])
+    return None
+
+
+def detect_format(path):
+    """首行为 `vocab_size dim` 且下一条记录不能按文本解析为 dim 个浮点数时判定为二进制格式"""
+    with open(path, "rb") as f:
+        header = parse_header(f.readline())
+        if header is None:
+            return "text"
+        record = f.readline()
+    try:
+        parts = record.decode("utf-8").split()
+        [float(x) for x in parts[1:]]
+        if len(parts) == header[1] + 1:
+            return "text"
+    except (UnicodeDecodeError, ValueError):
+        pass
+    return "binary"
+
+
+class Vocabulary:
+    """词 -> 行号，向量按行连续存放；重复的词覆盖原有向量（与 W2VEmbedder 的文本加载一致）"""
+
+    def __init__(self):
+        self.index = {}
+        self.rows = array("f")
+        self.dim = 0
+
+    def add(self, word, values):
+        if self.dim == 0:
+            self.dim = len(values)
+        if len(values) != self.dim:
+            return
+        row = self.index.get(word)
+        if row is None:
+            self.index[word] = len(self.index)
+            self.rows.extend(values)
+        else:
+            self.rows[row * self.dim:(row + 1) * self.dim] = array("f", values)
+
+
+def read_text(path, vocab):
+    with open(path, "rb") as f:
+        first = True
+        for line in f:
+            if first:
+                first = False
+                if parse_header(line) is not None:
+                    continue
+            parts = line.split()
+            if len(parts) < 2:
+                continue
+            try:
+                values = [float(x) for x in parts[1:]]
+            except ValueError:
+                continue
+            vocab.add(parts[0], values)
+
+
+def read_binary(path, vocab):
+    with open(path, "rb") as f:
+        header = parse_header(f.readline())
+        if header is None:
+            raise ValueError("缺少 `vocab_size dim` 文件头")
+        vocab_size, dim = header
+        row_bytes = dim * 4
+        for _ in range(vocab_size):
+            # 与 C++ 的 `file >> word` 一致：跳过前导空白，读到空格为止
+            word = bytearray()
+            while True:
+                c = f.read(1)
+                if not c:
+                    return
+                if c.isspace():
+                    if word:
+                        break
+                    continue
+                word += c
+            data = f.read(row_bytes)
+            if len(data) != row_bytes:
+                return
+            vocab.add(bytes(word), struct.unpack("<%df" % dim, data))
+
+
+def encode_rows(rows, dtype):
+    if dtype == "float32":
+        return rows.tobytes() if sys.byteorder == "little" else struct.pack("<%df" % len(rows), *rows)
+    if dtype == "fp16":
+        return struct.pack("<%de" % len(rows), *rows)
+    # bf16：float32 高 16 位，就近舍入到偶数（NaN 保持 NaN）
+    bits = struct.unpack("<%dI" % len(rows), struct.pack("<%df" % len(rows), *rows))
+    out = array("H")
+    for x in bits:
+        if (x & 0x7fffffff) > 0x7f800000:
+            out.append((x >> 16) | 0x40)
+        else:
+            out.append(((x + 0x7fff + ((x >> 16) & 1)) >> 16) & 0xffff)
+    return struct.pack("<%dH" % len(out), *out)
+
+
+def write_model(path, vocab, dtype):
+    words = sorted(vocab.index)
+    dim = vocab.dim
+    offsets = [0]
+    for w in words:
+        offsets.append(offsets[-1] + len(w))
+    words_offset = HEADER_SIZE
+    blob_end = words_offset + 8 * len(offsets) + offsets[-1]
+    matrix_offset = (blob_end + MATRIX_ALIGN - 1) // MATRIX_ALIGN * MATRIX_ALIGN
+    max_word_len = max((len(w) for w in words), default=0)
+
+    with open(path, "wb") as f:
+        header = MAGIC + struct.pack("<IIQIIQQ", VERSION, dim, len(words), DTYPES[dtype], max_word_len,
+                                     words_offset, matrix_offset)
+        f.write(header.ljust(HEADER_SIZE, b"\0"))
+        f.write(struct.pack("<%dQ" % len(offsets), *offsets))
+        for w in words:
+            f.write(w)
+        f.write(b"\0" * (matrix_offset - blob_end))
+        # 按排序后的词序逐块写出向量
+        chunk = array("f")
+        for w in words:
+            row = vocab.index[w]
+            chunk.extend(vocab.rows[row * dim:(row + 1) * dim])
+            if len(chunk) >= 1 << 20:
+                f.write(encode_rows(chunk, dtype))
+                chunk = array("f")
+        f.write(encode_rows(chunk, dtype))
+    return len(words), dim
+
+
+def main():
+    parser = argparse.ArgumentParser(description="word2vec 文本 / 二进制格式 -> 可映射的二进制词表格式")
+    parser.add_argument("input", help="输入词向量文件")
+    parser.add_argument("output", help="输出文件")
+    parser.add_argument("--format", choices=["auto", "text", "binary"], default="auto", help="输入格式")
+    parser.add_argument("--dtype", choices=sorted(DTYPES), default="float32", help="输出向量的存储精度")
+    args = parser.parse_args()
+
+    fmt = detect_format(args.input) if args.format == "auto" else args.format
+    print(f"读取 {args.input}（{fmt} 格式）...")
+    vocab = Vocabulary()
+    if fmt == "text":
+        read_text(args.input, vocab)
+    else:
+        read_binary(args.input, vocab)
+    if not vocab.index:
+        sys.exit("未读取到任何词向量")
+
+    count, dim = write_model(args.output, vocab, args.dtype)
+    print(f"已写入 {args.output}：{count} 个词，{dim} 维，{args.dtype}")
+
+
+if __name__ == "__main__":
+    main()
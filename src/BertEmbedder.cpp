@@ -1,26 +1,97 @@
 #include "../include/BertEmbedder.h"
 #include "../include/BertTokenizer.h"
+#include "../include/VectorOps.h"
 #include <iostream>
 #include <numeric>
 #include <cmath>
 #include <algorithm>
-#include <android/log.h>
+#include <map>
 
 #include <chrono>
 
 #define LOG_TAG "BertEmbedder"
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#include "../include/Log.h"
 
 #ifndef DISABLE_BERT
 
-BertEmbedder::BertEmbedder() : initialized_(false), embedding_dim_(0), max_seq_len_(128) {
+namespace {
+
+// 动态序列长度下的分桶长度：批内最长 token 数向上取整到其中之一，限制 ORT 需要规划的输入形状种类
+const size_t kSeqLenBuckets[] = {16, 32, 64, 128};
+
+// 空闲池最多保留的推理上下文数，超出的上下文归还时释放（秩为 3 的输出缓冲可达十余 MB）
+const size_t kMaxIdleContexts = 4;
+
+} // namespace
+
+// 一种输入形状的绑定；绑定的张量须在 binding 使用期间存活
+struct BertEmbedder::BoundShape {
+    Ort::IoBinding binding;
+    std::vector<Ort::Value> values;
+    
+    explicit BoundShape(Ort::Session& session) : binding(session) {}
+};
+
+// 一个线程独占使用的缓冲与绑定；绑定引用缓冲内存，缓冲重新分配时须先清空绑定
+struct BertEmbedder::RunContext {
+    size_t batch_size;
+    size_t generation;
+    std::map<std::pair<size_t, size_t>, std::unique_ptr<BoundShape> > bindings;
+    std::vector<int64_t> input_ids;
+    std::vector<int64_t> attention_mask;
+    std::vector<int64_t> token_type_ids;
+    std::vector<float> output;
+    
+    RunContext(size_t batch_size, size_t generation) : batch_size(batch_size), generation(generation) {}
+};
+
+BertEmbedder::BertEmbedder() : initialized_(false), embedding_dim_(0), max_batch_size_(32), max_seq_len_(128) {
     tokenizer_ = std::unique_ptr<BertTokenizer>(new BertTokenizer());
 }
 
 BertEmbedder::~BertEmbedder() {}
 
+bool BertEmbedder::resolve_input_roles() {
+    static const char* const kRoleNames[] = {"input_ids", "attention_mask", "token_type_ids"};
+    input_roles_.clear();
+    for (size_t i = 0; i < input_node_names_.size(); i++) {
+        std::string name(input_node_names_[i]);
+        InputRole role;
+        if (!input_config_.input_ids.empty() && name == input_config_.input_ids) {
+            role = ROLE_INPUT_IDS;
+        } else if (!input_config_.attention_mask.empty() && name == input_config_.attention_mask) {
+            role = ROLE_ATTENTION_MASK;
+        } else if (!input_config_.token_type_ids.empty() && name == input_config_.token_type_ids) {
+            role = ROLE_TOKEN_TYPE_IDS;
+        } else if (name.find("type") != std::string::npos || name.find("segment") != std::string::npos || name == "input.3") {
+            // token_type_ids / segment_ids
+            role = ROLE_TOKEN_TYPE_IDS;
+        } else if (name.find("mask") != std::string::npos || name == "input.2") {
+            role = ROLE_ATTENTION_MASK;
+        } else {
+            // 默认认为是 input_ids (input.1)
+            role = ROLE_INPUT_IDS;
+        }
+        input_roles_.push_back(role);
+        LOGI("输入节点 [%zu] '%s' -> 映射为 %s", i, name.c_str(), kRoleNames[role]);
+    }
+    
+    // 显式指定的节点名必须存在于模型中
+    const std::string* configured[] = {&input_config_.input_ids, &input_config_.attention_mask, &input_config_.token_type_ids};
+    for (const std::string* name : configured) {
+        if (name->empty()) continue;
+        bool found = false;
+        for (const char* input_name : input_node_names_) {
+            if (*name == input_name) found = true;
+        }
+        if (!found) {
+            LOGE("配置的输入节点不存在: %s", name->c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
 bool BertEmbedder::initialize(const std::string& model_path, const std::string& vocab_path) {
     try {
         if (!tokenizer_->load_vocab(vocab_path)) {
@@ -28,6 +99,13 @@ bool BertEmbedder::initialize(const std::string& model_path, const std::string&
             return false;
         }
         
+        // 旧会话上的绑定与按旧序列长度分配的缓冲全部作废，须在替换会话之前释放
+        {
+            std::lock_guard<std::mutex> lock(context_mutex_);
+            idle_contexts_.clear();
+            ++context_generation_;
+        }
+        
         env_ = std::unique_ptr<Ort::Env>(new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "BertEmbedder"));
         Ort::SessionOptions session_options;
         session_options.SetIntraOpNumThreads(4); // 增加线程数提高性能
@@ -46,10 +124,12 @@ bool BertEmbedder::initialize(const std::string& model_path, const std::string&
         input_node_names_.clear();
         for (size_t i = 0; i < num_input_nodes; i++) {
             auto name_ptr = session_->GetInputNameAllocated(i, allocator);
-            LOGI("输入节点 [%zu]: %s", i, name_ptr.get());
             input_node_names_allocated_.push_back(std::move(name_ptr));
             input_node_names_.push_back(input_node_names_allocated_.back().get());
         }
+        if (!resolve_input_roles()) {
+            return false;
+        }
 
         output_node_names_allocated_.clear();
         output_node_names_.clear();
@@ -60,11 +140,20 @@ bool BertEmbedder::initialize(const std::string& model_path, const std::string&
             LOGI("输出节点 [%zu]: %s", i, output_node_names_.back());
         }
         
+        // 输入的序列维为动态（-1）时按实际 token 数推理；固定时沿用模型导出的长度
+        auto input_shape = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        dynamic_seq_len_ = input_shape.size() == 2 && input_shape[1] < 0;
+        if (input_shape.size() == 2 && input_shape[1] > 0) {
+            max_seq_len_ = (size_t)input_shape[1];
+        }
+        LOGI("序列长度: %s, 最大 %zu", dynamic_seq_len_ ? "动态" : "固定", max_seq_len_);
+        
         // 获取输出节点维度
         auto output_node_type_info = session_->GetOutputTypeInfo(0);
         auto output_node_tensor_info = output_node_type_info.GetTensorTypeAndShapeInfo();
         auto output_shape = output_node_tensor_info.GetShape();
         embedding_dim_ = output_shape.back(); // 获取最后一个维度
+        output_rank_ = output_shape.size();
         
         LOGI("模型加载成功，维度: %d", embedding_dim_);
         initialized_ = true;
@@ -75,123 +164,249 @@ bool BertEmbedder::initialize(const std::string& model_path, const std::string&
     }
 }
 
+size_t BertEmbedder::bucket_seq_len(size_t length) const {
+    for (size_t bucket : kSeqLenBuckets) {
+        if (length <= bucket) return std::min(bucket, max_seq_len_);
+    }
+    return max_seq_len_;
+}
+
+std::unique_ptr<BertEmbedder::RunContext> BertEmbedder::acquire_context(size_t count) {
+    std::lock_guard<std::mutex> lock(context_mutex_);
+    if (count > max_batch_size_) {
+        LOGE("批大小超出上限: %zu > %zu", count, max_batch_size_);
+        return std::unique_ptr<RunContext>();
+    }
+    if (idle_contexts_.empty()) {
+        return std::unique_ptr<RunContext>(new RunContext(max_batch_size_, context_generation_));
+    }
+    std::unique_ptr<RunContext> context = std::move(idle_contexts_.back());
+    idle_contexts_.pop_back();
+    return context;
+}
+
+void BertEmbedder::release_context(std::unique_ptr<RunContext> context) {
+    std::lock_guard<std::mutex> lock(context_mutex_);
+    if (context->generation == context_generation_ && idle_contexts_.size() < kMaxIdleContexts) {
+        idle_contexts_.push_back(std::move(context));
+    }
+}
+
+BertEmbedder::BoundShape& BertEmbedder::bind_shape(RunContext& context, size_t count, size_t seq_len) {
+    // 缓冲按 batch_size × max_seq_len_ 在首次使用时一次分配到位，各形状的张量都是缓冲前缀上的视图
+    const size_t capacity = context.batch_size * max_seq_len_;
+    if (context.input_ids.size() < capacity) {
+        context.bindings.clear();
+        context.input_ids.assign(capacity, 0);
+        context.attention_mask.assign(capacity, 0);
+        context.token_type_ids.assign(capacity, 0);
+        if (embedding_dim_ > 0) {
+            context.output.assign((output_rank_ == 3 ? capacity : context.batch_size) * embedding_dim_, 0.0f);
+        }
+    }
+    
+    std::unique_ptr<BoundShape>& bound = context.bindings[std::make_pair(count, seq_len)];
+    if (bound) return *bound;
+    bound.reset(new BoundShape(*session_));
+    
+    const int64_t input_shape[] = {(int64_t)count, (int64_t)seq_len};
+    for (size_t i = 0; i < input_node_names_.size(); i++) {
+        std::vector<int64_t>* buffer = &context.input_ids;
+        if (input_roles_[i] == ROLE_ATTENTION_MASK) {
+            buffer = &context.attention_mask;
+        } else if (input_roles_[i] == ROLE_TOKEN_TYPE_IDS) {
+            buffer = &context.token_type_ids;
+        }
+        bound->values.push_back(Ort::Value::CreateTensor<int64_t>(
+            *memory_info_, buffer->data(), count * seq_len, input_shape, 2));
+        bound->binding.BindInput(input_node_names_[i], bound->values.back());
+    }
+    
+    if (embedding_dim_ > 0) {
+        // [count, seq_len, dim] 或 [count, dim]
+        const size_t dim = (size_t)embedding_dim_;
+        if (output_rank_ == 3) {
+            const int64_t output_shape[] = {(int64_t)count, (int64_t)seq_len, (int64_t)dim};
+            bound->values.push_back(Ort::Value::CreateTensor<float>(
+                *memory_info_, context.output.data(), count * seq_len * dim, output_shape, 3));
+        } else {
+            const int64_t output_shape[] = {(int64_t)count, (int64_t)dim};
+            bound->values.push_back(Ort::Value::CreateTensor<float>(
+                *memory_info_, context.output.data(), count * dim, output_shape, 2));
+        }
+        bound->binding.BindOutput(output_node_names_[0], bound->values.back());
+    } else {
+        // 输出维度未知时无法预分配，由 ORT 分配输出
+        bound->binding.BindOutput(output_node_names_[0], *memory_info_);
+    }
+    LOGD("创建 IoBinding: batch=%zu, seq_len=%zu", count, seq_len);
+    return *bound;
+}
+
+bool BertEmbedder::run_batch(const std::vector<std::vector<int64_t> >& token_ids, const size_t* indices, size_t count,
+                             std::vector<std::vector<float> >& results) {
+    std::unique_ptr<RunContext> context = acquire_context(count);
+    if (!context) {
+        return false;
+    }
+    bool ok;
+    try {
+        ok = run_with_context(*context, token_ids, indices, count, results);
+    } catch (...) {
+        release_context(std::move(context));
+        throw;
+    }
+    release_context(std::move(context));
+    return ok;
+}
+
+bool BertEmbedder::run_with_context(RunContext& context, const std::vector<std::vector<int64_t> >& token_ids,
+                                    const size_t* indices, size_t count, std::vector<std::vector<float> >& results) {
+    // 1. 本批的序列长度：动态时取批内最长 token 数所在的分桶，否则固定为 max_seq_len_
+    size_t seq_len = max_seq_len_;
+    if (dynamic_seq_len_) {
+        size_t longest = 0;
+        for (size_t b = 0; b < count; ++b) {
+            longest = std::max(longest, token_ids[indices[b]].size());
+        }
+        seq_len = bucket_seq_len(longest);
+    }
+    for (size_t b = 0; b < count; ++b) {
+        const std::vector<int64_t>& ids = token_ids[indices[b]];
+        if (ids.empty() || ids.size() > seq_len) {
+            LOGE("分词结果长度异常: %zu", ids.size());
+            return false;
+        }
+    }
+    
+    // 2. 写入绑定的输入缓冲 [count, seq_len]：[PAD] 补齐，attention_mask 只覆盖实际 token，token_type_ids 始终为 0
+    BoundShape& bound = bind_shape(context, count, seq_len);
+    std::vector<int64_t>& input_ids = context.input_ids;
+    std::vector<int64_t>& attention_mask = context.attention_mask;
+    std::fill(input_ids.begin(), input_ids.begin() + count * seq_len, tokenizer_->get_pad_id());
+    std::fill(attention_mask.begin(), attention_mask.begin() + count * seq_len, 0);
+    for (size_t b = 0; b < count; ++b) {
+        const std::vector<int64_t>& ids = token_ids[indices[b]];
+        std::copy(ids.begin(), ids.end(), input_ids.begin() + b * seq_len);
+        std::fill(attention_mask.begin() + b * seq_len, attention_mask.begin() + b * seq_len + ids.size(), 1);
+    }
+    
+    // 3. 运行推理，输出直接写入绑定的输出缓冲
+    session_->Run(Ort::RunOptions{nullptr}, bound.binding);
+
+    // 4. 处理输出：[count, seq_len, dim] 时对于 CoROM 等句子嵌入模型，通常采用 [CLS] 位置的向量 (即 index 0)
+    const float* output_data = context.output.data();
+    size_t dim = (size_t)std::max(embedding_dim_, 0);
+    size_t row_stride = output_rank_ == 3 ? seq_len * dim : dim;
+    std::vector<Ort::Value> output_tensors;
+    if (embedding_dim_ <= 0) {
+        output_tensors = bound.binding.GetOutputValues();
+        if (output_tensors.empty()) {
+            LOGE("推理输出为空");
+            return false;
+        }
+        output_data = output_tensors[0].GetTensorData<float>();
+        auto output_shape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+        if (output_shape.size() == 3 && output_shape[0] == (int64_t)count) {
+            dim = (size_t)output_shape[2];
+            row_stride = (size_t)output_shape[1] * dim;
+        } else if (output_shape.size() == 2 && output_shape[0] == (int64_t)count) {
+            dim = (size_t)output_shape[1];
+            row_stride = dim;
+        } else {
+            LOGE("推理输出形状异常: rank=%zu", output_shape.size());
+            return false;
+        }
+    }
+    for (size_t b = 0; b < count; ++b) {
+        const float* row = output_data + b * row_stride;
+        results[indices[b]].assign(row, row + dim);
+    }
+    return true;
+}
+
 std::vector<float> BertEmbedder::embed(const std::string& text) {
     if (!initialized_) {
         LOGE("BertEmbedder 未初始化，无法执行 embed");
         return std::vector<float>();
     }
     
-    auto start_time = std::chrono::high_resolution_clock::now();
     try {
-        // 1. 分词
-        std::vector<int64_t> input_ids = tokenizer_->tokenize(text, max_seq_len_);
-        if (input_ids.empty()) {
-            LOGE("分词结果为空: %s", text.c_str());
+        std::vector<std::vector<int64_t> > token_ids(1, tokenizer_->tokenize(text, max_seq_len_, false));
+        std::vector<std::vector<float> > results(1);
+        size_t index = 0;
+        if (!run_batch(token_ids, &index, 1, results)) {
             return std::vector<float>();
         }
         
-        // 2. 准备 attention_mask 和 token_type_ids
-        std::vector<int64_t> attention_mask(max_seq_len_, 0);
-        std::vector<int64_t> token_type_ids(max_seq_len_, 0);
-        
-        int64_t pad_id = tokenizer_->get_pad_id();
-        for (size_t i = 0; i < input_ids.size(); ++i) {
-            if (input_ids[i] != pad_id) {
-                attention_mask[i] = 1;
-            }
-        }
-        
-        // 3. 准备输入 Tensor
-        std::vector<int64_t> input_shape;
-        input_shape.push_back(1);
-        input_shape.push_back((int64_t)max_seq_len_);
-        
-        std::vector<Ort::Value> input_tensors;
-        input_tensors.reserve(input_node_names_.size());
-
-        for (size_t i = 0; i < input_node_names_.size(); i++) {
-            std::string name(input_node_names_[i]);
-            
-            // 更加鲁棒的名称匹配逻辑
-            if (name.find("type") != std::string::npos || name.find("segment") != std::string::npos || name == "input.3") {
-                // token_type_ids / segment_ids
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    *memory_info_, token_type_ids.data(), token_type_ids.size(), 
-                    input_shape.data(), input_shape.size()));
-                LOGI("输入节点 [%zu] '%s' -> 映射为 token_type_ids", i, name.c_str());
-            } else if (name.find("mask") != std::string::npos || name == "input.2") {
-                // attention_mask
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    *memory_info_, attention_mask.data(), attention_mask.size(), 
-                    input_shape.data(), input_shape.size()));
-                LOGI("输入节点 [%zu] '%s' -> 映射为 attention_mask", i, name.c_str());
-            } else {
-                // 默认认为是 input_ids (input.1)
-                input_tensors.push_back(Ort::Value::CreateTensor<int64_t>(
-                    *memory_info_, input_ids.data(), input_ids.size(), 
-                    input_shape.data(), input_shape.size()));
-                LOGI("输入节点 [%zu] '%s' -> 映射为 input_ids", i, name.c_str());
-            }
-        }
-        
-        // 4. 运行推理
-        auto output_tensors = session_->Run(Ort::RunOptions{nullptr}, input_node_names_.data(), input_tensors.data(), input_tensors.size(), output_node_names_.data(), output_node_names_.size());
-        
-        if (output_tensors.empty()) {
-            LOGE("推理输出为空");
-            return std::vector<float>();
-        }
+        // L2 归一化
+        std::vector<float>& res = results[0];
+        VectorOps::l2_normalize(res.data(), res.size(), 1e-6f);
+        return std::move(res);
+    } catch (const std::exception& e) {
+        LOGE("推理异常: %s", e.what());
+        return std::vector<float>();
+    }
+}
 
-        // 5. 处理输出
-        float* output_data = output_tensors[0].GetTensorMutableData<float>();
-        auto output_shape = output_tensors.front().GetTensorTypeAndShapeInfo().GetShape();
-
-        std::vector<float> res;
-        if (output_shape.size() == 3) {
-            // [1, seq_len, dim]
-            int seq_len = output_shape[1];
-            int dim = output_shape[2];
-            res.resize(dim, 0.0f);
-            
-            // 对于 CoROM 等句子嵌入模型，通常采用 [CLS] 位置的向量 (即 index 0)
-            LOGI("使用 CLS Pooling (Index 0)");
-            for (int j = 0; j < dim; ++j) {
-                res[j] = output_data[j];
+std::vector<std::vector<float> > BertEmbedder::embed_batch(const std::vector<std::string>& texts) {
+    std::vector<std::vector<float> > results(texts.size());
+    if (!initialized_) {
+        LOGE("BertEmbedder 未初始化，无法执行 embed_batch");
+        return results;
+    }
+    
+    // 批大小只读取一次，切批过程中不受并发的 set_max_batch_size 影响
+    size_t batch_size;
+    {
+        std::lock_guard<std::mutex> lock(context_mutex_);
+        batch_size = max_batch_size_;
+    }
+    
+    // 先整体分词，再按 token 数排序后切批：同一批内长度接近，补齐的 [PAD] 最少
+    std::vector<std::vector<int64_t> > token_ids(texts.size());
+    for (size_t i = 0; i < texts.size(); ++i) {
+        token_ids[i] = tokenizer_->tokenize(texts[i], max_seq_len_, false);
+    }
+    std::vector<size_t> order(texts.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&token_ids](size_t a, size_t b) {
+        return token_ids[a].size() < token_ids[b].size();
+    });
+    
+    for (size_t begin = 0; begin < texts.size(); begin += batch_size) {
+        size_t count = std::min(batch_size, texts.size() - begin);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        try {
+            if (!run_batch(token_ids, order.data() + begin, count, results)) {
+                continue;
             }
-        } else if (output_shape.size() == 2) {
-            // [1, dim]
-            int dim = output_shape[1];
-            res.assign(output_data, output_data + dim);
+        } catch (const std::exception& e) {
+            LOGE("批量推理异常: %s", e.what());
+            continue;
         }
-        
-        // 6. L2 归一化
-        float norm = 0;
-        for (float v : res) norm += v * v;
-        norm = std::sqrt(norm);
-        
-        // 记录原始向量的一些统计信息
-        float mean = 0;
-        for (float v : res) mean += v;
-        mean /= res.size();
-
-        if (norm > 1e-6) {
-            for (float& v : res) v /= norm;
+        for (size_t b = begin; b < begin + count; ++b) {
+            std::vector<float>& res = results[order[b]];
+            VectorOps::l2_normalize(res.data(), res.size(), 1e-6f);
         }
         
         auto end_time = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        
-        LOGI("BERT 推理完成: text='%s', 耗时=%lldms, dim=%zu, norm=%f, mean=%f, first_5=[%f, %f, %f, %f, %f]", 
-             text.c_str(), duration, res.size(), norm, mean, 
-             res.size() > 0 ? res[0] : 0, res.size() > 1 ? res[1] : 0, 
-             res.size() > 2 ? res[2] : 0, res.size() > 3 ? res[3] : 0, 
-             res.size() > 4 ? res[4] : 0);
-        
-        return res;
-    } catch (const std::exception& e) {
-        LOGE("推理异常: %s", e.what());
-        return std::vector<float>();
+        LOGD("BERT 批量推理完成: %zu-%zu / %zu, 耗时=%lldms", begin, begin + count, texts.size(), (long long)duration);
     }
+    return results;
+}
+
+void BertEmbedder::set_input_config(const BertInputConfig& config) {
+    input_config_ = config;
+}
+
+void BertEmbedder::set_max_batch_size(size_t max_batch_size) {
+    std::lock_guard<std::mutex> lock(context_mutex_);
+    max_batch_size_ = std::max<size_t>(1, max_batch_size);
+    // 预分配缓冲按批大小确定，改变后上下文全部重建
+    idle_contexts_.clear();
+    ++context_generation_;
 }
 
 int BertEmbedder::get_embedding_dim() const {
@@ -205,13 +420,18 @@ size_t BertEmbedder::get_memory_usage() const {
 
 #else // DISABLE_BERT
 
-BertEmbedder::BertEmbedder() : initialized_(false), embedding_dim_(0) {}
+BertEmbedder::BertEmbedder() : initialized_(false), embedding_dim_(0), max_batch_size_(32) {}
 BertEmbedder::~BertEmbedder() {}
 bool BertEmbedder::initialize(const std::string& model_path, const std::string& vocab_path) {
     std::cerr << "BERT 功能已禁用 (编译时未包含 ONNX Runtime)" << std::endl;
     return false;
 }
 std::vector<float> BertEmbedder::embed(const std::string& text) { return std::vector<float>(); }
+std::vector<std::vector<float> > BertEmbedder::embed_batch(const std::vector<std::string>& texts) {
+    return std::vector<std::vector<float> >(texts.size());
+}
+void BertEmbedder::set_max_batch_size(size_t max_batch_size) { max_batch_size_ = std::max<size_t>(1, max_batch_size); }
+void BertEmbedder::set_input_config(const BertInputConfig& config) { input_config_ = config; }
 int BertEmbedder::get_embedding_dim() const { return 0; }
 size_t BertEmbedder::get_memory_usage() const { return 0; }
 
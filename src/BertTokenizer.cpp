@@ -13,18 +13,6 @@ bool is_punctuation(unsigned char c) {
     return false;
 }
 
-// 检查是否是中文标点或特殊字符 (UTF-8)
-bool is_chinese_punctuation(const std::string& s) {
-    // 常见中文标点符号的 UTF-8 编码
-    static const char* punctuations[] = {
-        "。", "，", "；", "：", "？", "！", "（", "）", "【", "】", "《", "》", "“", "”", "‘", "’", "、"
-    };
-    for (size_t i = 0; i < sizeof(punctuations) / sizeof(punctuations[0]); ++i) {
-        if (s == punctuations[i]) return true;
-    }
-    return false;
-}
-
 bool BertTokenizer::load_vocab(const std::string& vocab_path) {
     std::ifstream file(vocab_path);
     if (!file.is_open()) {
@@ -32,23 +20,36 @@ bool BertTokenizer::load_vocab(const std::string& vocab_path) {
         return false;
     }
     
+    vocab_.clear();
+    vocab_ids_.clear();
     std::string line;
     int64_t id = 0;
     while (std::getline(file, line)) {
         if (!line.empty() && line.back() == '\r') line.pop_back();
-        vocab_[line] = id++;
+        std::pair<uint32_t, bool> inserted = vocab_.insert(line);
+        if (inserted.second) {
+            vocab_ids_.push_back(id);
+        } else {
+            vocab_ids_[inserted.first] = id;
+        }
+        id++;
     }
     
     // 获取特殊字符 ID
-    if (vocab_.count("[CLS]")) cls_id_ = vocab_["[CLS]"];
-    if (vocab_.count("[SEP]")) sep_id_ = vocab_["[SEP]"];
-    if (vocab_.count("[UNK]")) unk_id_ = vocab_["[UNK]"];
-    if (vocab_.count("[PAD]")) pad_id_ = vocab_["[PAD]"];
+    if (lookup("[CLS]") >= 0) cls_id_ = lookup("[CLS]");
+    if (lookup("[SEP]") >= 0) sep_id_ = lookup("[SEP]");
+    if (lookup("[UNK]") >= 0) unk_id_ = lookup("[UNK]");
+    if (lookup("[PAD]") >= 0) pad_id_ = lookup("[PAD]");
     
     initialized_ = true;
     return true;
 }
 
+int64_t BertTokenizer::lookup(std::string_view token) const {
+    uint32_t row = vocab_.find(token);
+    return row == VocabHashTable::kNotFound ? -1 : vocab_ids_[row];
+}
+
 // 检查是否是控制字符
 bool is_control(unsigned char c) {
     if (c == '\t' || c == '\n' || c == '\r') return false;
@@ -56,9 +57,10 @@ bool is_control(unsigned char c) {
     return false;
 }
 
-std::vector<std::string> BertTokenizer::split_text(const std::string& text) {
-    std::vector<std::string> tokens;
-    std::string clean_text;
+void BertTokenizer::split_text(const std::string& text, std::string& clean_text,
+                               std::vector<std::string_view>& tokens) const {
+    clean_text.clear();
+    clean_text.reserve(text.length());
     
     // 预处理：转小写，过滤控制字符
     for (size_t k = 0; k < text.length(); ++k) {
@@ -82,98 +84,99 @@ std::vector<std::string> BertTokenizer::split_text(const std::string& text) {
         }
 
         if (is_punctuation(c)) {
-            tokens.push_back(std::string(1, clean_text[i++]));
+            tokens.push_back(std::string_view(clean_text.data() + i, 1));
+            i++;
             continue;
         }
 
         if (c < 128) {
             // 英文数字连在一起，直到遇到空格、标点或非ASCII
-            std::string s;
+            size_t begin = i;
             while (i < clean_text.length()) {
                 unsigned char cur = (unsigned char)clean_text[i];
                 if (isspace(cur) || is_punctuation(cur) || cur >= 128) {
                     break;
                 }
-                s += clean_text[i++];
+                i++;
             }
-            if (!s.empty()) tokens.push_back(s);
+            if (i > begin) tokens.push_back(std::string_view(clean_text.data() + begin, i - begin));
         } else {
-            // 中文字符：按字符切分
+            // 中文字符（含中文标点）：按字符切分
             size_t char_len = 1;
             if (c >= 0xF0) char_len = 4;
             else if (c >= 0xE0) char_len = 3;
             else if (c >= 0xC0) char_len = 2;
             
             if (i + char_len > clean_text.length()) char_len = clean_text.length() - i;
-            std::string utf8_char = clean_text.substr(i, char_len);
-            
-            // 检查是否是中文标点
-            if (is_chinese_punctuation(utf8_char)) {
-                tokens.push_back(utf8_char);
-            } else {
-                tokens.push_back(utf8_char);
-            }
+            tokens.push_back(std::string_view(clean_text.data() + i, char_len));
             i += char_len;
         }
     }
-    return tokens;
 }
 
-void BertTokenizer::wordpiece_tokenize(const std::string& token, std::vector<int64_t>& ids) {
-    if (vocab_.count(token)) {
-        ids.push_back(vocab_[token]);
+void BertTokenizer::wordpiece_tokenize(std::string_view token, std::string& buffer, std::vector<int64_t>& ids) const {
+    int64_t id = lookup(token);
+    if (id >= 0) {
+        ids.push_back(id);
         return;
     }
     
-    std::vector<int64_t> sub_ids;
+    // 贪心最长匹配子词；任一段匹配失败时整个词记为 [UNK]
+    const size_t mark = ids.size();
     size_t start = 0;
     while (start < token.length()) {
         size_t end = token.length();
-        std::string cur_substr;
-        bool found = false;
+        int64_t sub_id = -1;
         
         while (start < end) {
-            std::string sub = token.substr(start, end - start);
-            if (start > 0) sub = "##" + sub;
-            
-            if (vocab_.count(sub)) {
-                cur_substr = sub;
-                found = true;
+            std::string_view sub = token.substr(start, end - start);
+            if (start > 0) {
+                buffer.assign("##");
+                buffer.append(sub.data(), sub.size());
+                sub_id = lookup(buffer);
+            } else {
+                sub_id = lookup(sub);
+            }
+            if (sub_id >= 0) {
                 break;
             }
             end--;
         }
         
-        if (!found) {
+        if (sub_id < 0) {
+            ids.resize(mark);
             ids.push_back(unk_id_);
             return;
         }
         
-        sub_ids.push_back(vocab_[cur_substr]);
+        ids.push_back(sub_id);
         start = end;
     }
-    
-    ids.insert(ids.end(), sub_ids.begin(), sub_ids.end());
 }
 
-std::vector<int64_t> BertTokenizer::tokenize(const std::string& text, size_t max_len) {
+std::vector<int64_t> BertTokenizer::tokenize(const std::string& text, size_t max_len, bool pad) {
     std::vector<int64_t> ids;
     ids.push_back(cls_id_);
     
-    std::vector<std::string> tokens = split_text(text);
-    for (const auto& token : tokens) {
-        wordpiece_tokenize(token, ids);
+    std::string clean_text;
+    std::string buffer;
+    std::vector<std::string_view> tokens;
+    split_text(text, clean_text, tokens);
+    for (std::string_view token : tokens) {
+        wordpiece_tokenize(token, buffer, ids);
         if (ids.size() >= max_len - 1) break;
     }
     
     if (ids.size() < max_len) {
         ids.push_back(sep_id_);
     } else {
+        // 最后一个词拆出的多个子词可能超出 max_len
+        ids.resize(max_len);
         ids[max_len - 1] = sep_id_;
     }
     
     // Padding
-    while (ids.size() < max_len) {
+    while (pad && ids.size() < max_len) {
         ids.push_back(pad_id_);
     }
     
@@ -0,0 +1,96 @@
+#include "../include/BinaryCodeStore.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+
+namespace {
+
+// 扫描时每块先批量算汉明距离再挑选最优
+const size_t kScanBlockRows = 256;
+
+} // namespace
+
+BinaryCodeStore::BinaryCodeStore() : dim_(0), words_(0), count_(0) {}
+
+void BinaryCodeStore::clear() {
+    mean_.clear();
+    codes_.clear();
+    dim_ = 0;
+    words_ = 0;
+    count_ = 0;
+}
+
+void BinaryCodeStore::encode(const float* vec, uint64_t* out) const {
+    std::fill(out, out + words_, 0ull);
+    for (size_t d = 0; d < dim_; ++d) {
+        if (vec[d] > mean_[d]) {
+            out[d >> 6] |= 1ull << (d & 63);
+        }
+    }
+}
+
+void BinaryCodeStore::build(const VectorView& vectors, size_t count) {
+    clear();
+    if (count == 0 || vectors.dim == 0) return;
+    dim_ = vectors.dim;
+    words_ = (dim_ + 63) / 64;
+
+    std::vector<double> sum(dim_, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        const float* vec = vectors.row(i);
+        for (size_t d = 0; d < dim_; ++d) sum[d] += vec[d];
+    }
+    mean_.resize(dim_);
+    for (size_t d = 0; d < dim_; ++d) {
+        mean_[d] = static_cast<float>(sum[d] / count);
+    }
+
+    codes_.resize(count * words_);
+    for (size_t i = 0; i < count; ++i) {
+        encode(vectors.row(i), &codes_[i * words_]);
+    }
+    count_ = count;
+}
+
+void BinaryCodeStore::add(const float* vec) {
+    if (words_ == 0) return;
+    codes_.resize(codes_.size() + words_);
+    encode(vec, &codes_[count_ * words_]);
+    count_++;
+}
+
+void BinaryCodeStore::scan(const uint64_t* query, size_t begin, size_t end, TopKHeap& heap) const {
+    uint32_t dists[kScanBlockRows];
+    for (size_t start = begin; start < end; start += kScanBlockRows) {
+        size_t block = std::min(kScanBlockRows, end - start);
+        VectorOps::hamming_rows(query, &codes_[start * words_], words_, block, dists);
+        for (size_t j = 0; j < block; ++j) {
+            heap.push(-static_cast<float>(dists[j]), start + j);
+        }
+    }
+}
+
+size_t BinaryCodeStore::get_memory_usage() const {
+    return codes_.capacity() * sizeof(uint64_t) + mean_.capacity() * sizeof(float);
+}
+
+void BinaryCodeStore::save(BinaryWriter& out) const {
+    out.write_pod<uint64_t>(dim_);
+    out.write_pod<uint64_t>(count_);
+    out.write_vector(mean_);
+    out.write_vector(codes_);
+}
+
+bool BinaryCodeStore::load(BinaryReader& in) {
+    clear();
+    uint64_t dim = 0, count = 0;
+    bool valid = in.read_pod(dim) && in.read_pod(count) && in.read_vector(mean_) && in.read_vector(codes_) &&
+                 mean_.size() == dim && codes_.size() == count * ((dim + 63) / 64);
+    if (!valid) {
+        clear();
+        return false;
+    }
+    dim_ = static_cast<size_t>(dim);
+    words_ = (dim_ + 63) / 64;
+    count_ = static_cast<size_t>(count);
+    return true;
+}
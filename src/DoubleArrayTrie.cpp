@@ -0,0 +1,111 @@
+#include "../include/DoubleArrayTrie.h"
+#include <algorithm>
+
+namespace {
+
+// 搜索起点之前的区域填充率达到该值后整体跳过，避免每次都从头扫描已基本占满的区域
+const double kDenseRatio = 0.95;
+
+} // namespace
+
+DoubleArrayTrie::DoubleArrayTrie() : next_check_pos_(0), keys_(nullptr), values_(nullptr) {
+    clear();
+}
+
+void DoubleArrayTrie::clear() {
+    Unit root = { 0, 0, kNoValue };
+    units_.assign(1, root);
+    units_.shrink_to_fit();
+    std::vector<bool>().swap(used_base_);
+}
+
+void DoubleArrayTrie::ensure_size(size_t size) {
+    if (size <= units_.size()) return;
+    Unit free_unit = { 0, -1, kNoValue };
+    size_t capacity = units_.size();
+    while (capacity < size) capacity *= 2;
+    units_.resize(capacity, free_unit);
+    used_base_.resize(capacity, false);
+}
+
+void DoubleArrayTrie::build(const std::vector<std::string_view>& keys, const std::vector<uint32_t>& values) {
+    clear();
+    size_t begin = 0;
+    while (begin < keys.size() && keys[begin].empty()) ++begin;
+    if (begin == keys.size() || keys.size() != values.size()) return;
+
+    keys_ = &keys;
+    values_ = &values;
+    next_check_pos_ = 0;
+    ensure_size(512);
+    insert_children(0, begin, keys.size(), 0);
+    keys_ = nullptr;
+    values_ = nullptr;
+
+    // 去掉尾部空闲单元，释放构建期数据
+    size_t size = units_.size();
+    while (size > 1 && units_[size - 1].check < 0) --size;
+    units_.resize(size);
+    units_.shrink_to_fit();
+    std::vector<bool>().swap(used_base_);
+}
+
+void DoubleArrayTrie::insert_children(uint32_t state, size_t begin, size_t end, size_t depth) {
+    const std::vector<std::string_view>& keys = *keys_;
+    // 有序输入中恰好等于前缀的键排在最前，它在本状态结束
+    if (keys[begin].size() == depth) {
+        units_[state].value = (*values_)[begin];
+        ++begin;
+    }
+    if (begin == end) return;
+
+    // 收集子节点标签（字节 + 1）及各自的键区间
+    std::vector<uint32_t> labels;
+    std::vector<size_t> bounds;
+    for (size_t i = begin; i < end; ++i) {
+        uint32_t label = static_cast<unsigned char>(keys[i][depth]) + 1u;
+        if (labels.empty() || labels.back() != label) {
+            labels.push_back(label);
+            bounds.push_back(i);
+        }
+    }
+    bounds.push_back(end);
+
+    // 寻找 base：使所有 base + label 均空闲
+    size_t pos = std::max<size_t>(labels[0], next_check_pos_);
+    size_t nonzero = 0;
+    bool first_free = true;
+    size_t base = 0;
+    while (true) {
+        ++pos;
+        ensure_size(pos + 1);
+        if (units_[pos].check >= 0) {
+            ++nonzero;
+            continue;
+        }
+        if (first_free) {
+            next_check_pos_ = pos;
+            first_free = false;
+        }
+        base = pos - labels[0];
+        ensure_size(base + labels.back() + 1);
+        if (used_base_[base]) continue;
+        bool fits = true;
+        for (size_t j = 1; j < labels.size() && fits; ++j) {
+            fits = units_[base + labels[j]].check < 0;
+        }
+        if (fits) break;
+    }
+    if (static_cast<double>(nonzero) / static_cast<double>(pos - next_check_pos_ + 1) >= kDenseRatio) {
+        next_check_pos_ = pos;
+    }
+
+    used_base_[base] = true;
+    units_[state].base = static_cast<int32_t>(base);
+    for (size_t j = 0; j < labels.size(); ++j) {
+        units_[base + labels[j]].check = static_cast<int32_t>(state);
+    }
+    for (size_t j = 0; j < labels.size(); ++j) {
+        insert_children(static_cast<uint32_t>(base + labels[j]), bounds[j], bounds[j + 1], depth + 1);
+    }
+}
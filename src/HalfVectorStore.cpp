@@ -0,0 +1,81 @@
+#include "../include/HalfVectorStore.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+
+namespace {
+
+// 行对齐元素数（64 字节）
+const size_t kRowAlign = 32;
+// 扫描时每块先批量算点积再挑选最优
+const size_t kScanBlockRows = 256;
+
+} // namespace
+
+HalfVectorStore::HalfVectorStore() : type_(HALF_FP16), dim_(0), stride_(0), count_(0) {}
+
+void HalfVectorStore::clear() {
+    rows_.clear();
+    dim_ = 0;
+    stride_ = 0;
+    count_ = 0;
+}
+
+void HalfVectorStore::build(const VectorView& vectors, size_t count, HalfType type) {
+    clear();
+    if (vectors.dim == 0) return;
+    type_ = type;
+    dim_ = vectors.dim;
+    stride_ = (dim_ + kRowAlign - 1) / kRowAlign * kRowAlign;
+    rows_.assign(count * stride_, 0);
+    for (size_t i = 0; i < count; ++i) {
+        float_to_half(vectors.row(i), &rows_[i * stride_], dim_, type_);
+    }
+    count_ = count;
+}
+
+void HalfVectorStore::add(const float* vec) {
+    if (stride_ == 0) return;
+    rows_.resize(rows_.size() + stride_, 0);
+    float_to_half(vec, &rows_[count_ * stride_], dim_, type_);
+    count_++;
+}
+
+void HalfVectorStore::scan(const float* query, size_t begin, size_t end, TopKHeap& heap) const {
+    float scores[kScanBlockRows];
+    for (size_t start = begin; start < end; start += kScanBlockRows) {
+        size_t block = std::min(kScanBlockRows, end - start);
+        VectorOps::dot_rows_half(query, &rows_[start * stride_], stride_, block, dim_, type_, scores);
+        for (size_t j = 0; j < block; ++j) {
+            heap.push(scores[j], start + j);
+        }
+    }
+}
+
+size_t HalfVectorStore::get_memory_usage() const {
+    return rows_.capacity() * sizeof(uint16_t);
+}
+
+void HalfVectorStore::save(BinaryWriter& out) const {
+    out.write_pod<uint32_t>(type_);
+    out.write_pod<uint64_t>(dim_);
+    out.write_pod<uint64_t>(stride_);
+    out.write_pod<uint64_t>(count_);
+    out.write_vector(rows_);
+}
+
+bool HalfVectorStore::load(BinaryReader& in) {
+    clear();
+    uint32_t type = 0;
+    uint64_t dim = 0, stride = 0, count = 0;
+    bool valid = in.read_pod(type) && in.read_pod(dim) && in.read_pod(stride) && in.read_pod(count) &&
+                 in.read_vector(rows_) && type <= HALF_BF16 && dim <= stride && rows_.size() == count * stride;
+    if (!valid) {
+        clear();
+        return false;
+    }
+    type_ = static_cast<HalfType>(type);
+    dim_ = static_cast<size_t>(dim);
+    stride_ = static_cast<size_t>(stride);
+    count_ = static_cast<size_t>(count);
+    return true;
+}
@@ -0,0 +1,379 @@
+#include "../include/HnswIndex.h"
+#include "../include/VectorOps.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// 快照中允许的最大层数：random_level() 的取值不超过 -ln(1e-12) / ln(2) ≈ 40，更大的值只可能来自损坏的文件
+const int kMaxLevel = 64;
+
+struct ScoreLess {
+    template <typename T>
+    bool operator()(const T& a, const T& b) const { return a.score < b.score; }
+};
+
+struct ScoreGreater {
+    template <typename T>
+    bool operator()(const T& a, const T& b) const { return a.score > b.score; }
+};
+
+} // namespace
+
+// 访问标记复用池：每个标记数组按"轮次"区分是否已访问，避免每次检索清零整个数组
+class HnswIndex::VisitedPool {
+public:
+    struct List {
+        std::vector<uint16_t> tags;
+        uint16_t epoch;
+
+        List() : epoch(0) {}
+
+        bool test_and_set(uint32_t id) {
+            if (tags[id] == epoch) return true;
+            tags[id] = epoch;
+            return false;
+        }
+    };
+
+    std::unique_ptr<List> acquire(size_t size) {
+        std::unique_ptr<List> list;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_.empty()) {
+                list = std::move(free_.back());
+                free_.pop_back();
+            }
+        }
+        if (!list) list.reset(new List());
+        if (list->tags.size() < size) list->tags.resize(size, 0);
+        if (++list->epoch == 0) {
+            std::fill(list->tags.begin(), list->tags.end(), 0);
+            list->epoch = 1;
+        }
+        return list;
+    }
+
+    void release(std::unique_ptr<List> list) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(std::move(list));
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.clear();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<List> > free_;
+};
+
+HnswIndex::HnswIndex()
+    : max_links_(0), max_links0_(0), level_mult_(0.0), entry_point_(0), max_level_(-1),
+      rng_(100), visited_pool_(new VisitedPool()) {
+    configure(HnswConfig());
+}
+
+HnswIndex::~HnswIndex() {}
+
+void HnswIndex::clear() {
+    level0_.clear();
+    upper_.clear();
+    levels_.clear();
+    entry_point_ = 0;
+    max_level_ = -1;
+    rng_.seed(100);
+    visited_pool_->clear();
+}
+
+void HnswIndex::configure(const HnswConfig& config) {
+    config_ = config;
+    max_links_ = static_cast<size_t>(std::max(2, config.M));
+    max_links0_ = max_links_ * 2;
+    level_mult_ = 1.0 / std::log(static_cast<double>(max_links_));
+}
+
+void HnswIndex::build(const VectorView& vectors, size_t count, const HnswConfig& config) {
+    clear();
+    configure(config);
+
+    level0_.reserve(count * (max_links0_ + 1));
+    levels_.reserve(count);
+    upper_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        add(vectors);
+    }
+}
+
+void HnswIndex::add(const VectorView& vectors) {
+    uint32_t node = static_cast<uint32_t>(levels_.size());
+    level0_.resize(level0_.size() + max_links0_ + 1, 0);
+    levels_.push_back(0);
+    upper_.push_back(std::vector<uint32_t>());
+    insert(vectors, node);
+}
+
+int HnswIndex::random_level() {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double r = uniform(rng_);
+    if (r <= 0.0) r = 1e-12;
+    return static_cast<int>(-std::log(r) * level_mult_);
+}
+
+void HnswIndex::insert(const VectorView& vectors, uint32_t node) {
+    int level = random_level();
+    levels_[node] = level;
+    if (level > 0) {
+        upper_[node].assign(static_cast<size_t>(level) * (max_links_ + 1), 0);
+    }
+
+    if (max_level_ < 0) {
+        entry_point_ = node;
+        max_level_ = level;
+        return;
+    }
+
+    const float* query = vectors.row(node);
+    uint32_t entry = entry_point_;
+    if (level < max_level_) {
+        entry = greedy_descend(vectors, query, entry, max_level_, level + 1);
+    }
+
+    size_t ef = static_cast<size_t>(std::max(config_.ef_construction, config_.M));
+    for (int l = std::min(level, max_level_); l >= 0; --l) {
+        std::vector<Candidate> candidates = search_layer(vectors, query, entry, ef, l);
+        std::vector<Candidate> neighbors = select_neighbors(vectors, candidates, max_links_);
+        // select_neighbors 已将候选按相似度降序排列，下一层从本层最相似的节点出发
+        entry = candidates[0].id;
+
+        uint32_t* node_links = links(node, l);
+        node_links[0] = static_cast<uint32_t>(neighbors.size());
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            node_links[i + 1] = neighbors[i].id;
+        }
+        for (size_t i = 0; i < neighbors.size(); ++i) {
+            connect(vectors, neighbors[i].id, node, l);
+        }
+    }
+
+    if (level > max_level_) {
+        entry_point_ = node;
+        max_level_ = level;
+    }
+}
+
+uint32_t HnswIndex::greedy_descend(const VectorView& vectors, const float* query, uint32_t entry,
+                                   int from_level, int to_level) const {
+    uint32_t current = entry;
+    float current_score = VectorOps::dot(query, vectors.row(current), vectors.dim);
+    for (int level = from_level; level >= to_level; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const uint32_t* node_links = links(current, level);
+            for (uint32_t i = 1; i <= node_links[0]; ++i) {
+                uint32_t candidate = node_links[i];
+                float score = VectorOps::dot(query, vectors.row(candidate), vectors.dim);
+                if (score > current_score) {
+                    current_score = score;
+                    current = candidate;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::search_layer(const VectorView& vectors, const float* query,
+                                                          uint32_t entry, size_t ef, int level) const {
+    std::unique_ptr<VisitedPool::List> visited = visited_pool_->acquire(levels_.size());
+
+    // candidates 为待扩展队列（堆顶最相似），results 为当前最优集合（堆顶最差）
+    std::priority_queue<Candidate, std::vector<Candidate>, ScoreLess> candidates;
+    std::priority_queue<Candidate, std::vector<Candidate>, ScoreGreater> results;
+
+    Candidate start = { VectorOps::dot(query, vectors.row(entry), vectors.dim), entry };
+    candidates.push(start);
+    results.push(start);
+    visited->test_and_set(entry);
+
+    while (!candidates.empty()) {
+        Candidate current = candidates.top();
+        if (results.size() >= ef && current.score < results.top().score) break;
+        candidates.pop();
+
+        const uint32_t* node_links = links(current.id, level);
+        for (uint32_t i = 1; i <= node_links[0]; ++i) {
+            uint32_t neighbor = node_links[i];
+            if (visited->test_and_set(neighbor)) continue;
+            float score = VectorOps::dot(query, vectors.row(neighbor), vectors.dim);
+            if (results.size() < ef || score > results.top().score) {
+                Candidate next = { score, neighbor };
+                candidates.push(next);
+                results.push(next);
+                if (results.size() > ef) results.pop();
+            }
+        }
+    }
+    visited_pool_->release(std::move(visited));
+
+    std::vector<Candidate> found;
+    found.reserve(results.size());
+    while (!results.empty()) {
+        found.push_back(results.top());
+        results.pop();
+    }
+    return found;
+}
+
+// 启发式邻居选择（HNSW 论文算法 4）：候选与已选邻居的相似度高于与目标的相似度时跳过，
+// 使邻居分布在不同方向上，保持图的连通性
+std::vector<HnswIndex::Candidate> HnswIndex::select_neighbors(const VectorView& vectors,
+                                                              std::vector<Candidate>& candidates,
+                                                              size_t max_count) const {
+    std::sort(candidates.begin(), candidates.end(), ScoreGreater());
+    std::vector<Candidate> selected;
+    selected.reserve(max_count);
+    for (size_t i = 0; i < candidates.size() && selected.size() < max_count; ++i) {
+        const float* vec = vectors.row(candidates[i].id);
+        bool keep = true;
+        for (size_t j = 0; j < selected.size(); ++j) {
+            if (VectorOps::dot(vec, vectors.row(selected[j].id), vectors.dim) > candidates[i].score) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) selected.push_back(candidates[i]);
+    }
+    return selected;
+}
+
+void HnswIndex::connect(const VectorView& vectors, uint32_t node, uint32_t neighbor, int level) {
+    uint32_t* node_links = links(node, level);
+    size_t capacity = level == 0 ? max_links0_ : max_links_;
+    if (node_links[0] < capacity) {
+        node_links[++node_links[0]] = neighbor;
+        return;
+    }
+
+    // 邻居已满：在原邻居与新节点中重新挑选
+    const float* vec = vectors.row(node);
+    std::vector<Candidate> candidates;
+    candidates.reserve(capacity + 1);
+    for (uint32_t i = 1; i <= node_links[0]; ++i) {
+        Candidate c = { VectorOps::dot(vec, vectors.row(node_links[i]), vectors.dim), node_links[i] };
+        candidates.push_back(c);
+    }
+    Candidate added = { VectorOps::dot(vec, vectors.row(neighbor), vectors.dim), neighbor };
+    candidates.push_back(added);
+
+    std::vector<Candidate> selected = select_neighbors(vectors, candidates, capacity);
+    node_links[0] = static_cast<uint32_t>(selected.size());
+    for (size_t i = 0; i < selected.size(); ++i) {
+        node_links[i + 1] = selected[i].id;
+    }
+}
+
+std::vector<TopKHeap::Entry> HnswIndex::search(const VectorView& vectors, const float* query,
+                                               size_t top_k, size_t ef) const {
+    if (levels_.empty() || top_k == 0) {
+        return std::vector<TopKHeap::Entry>();
+    }
+
+    uint32_t entry = entry_point_;
+    if (max_level_ > 0) {
+        entry = greedy_descend(vectors, query, entry, max_level_, 1);
+    }
+    std::vector<Candidate> found = search_layer(vectors, query, entry, std::max(ef, top_k), 0);
+
+    TopKHeap heap(top_k);
+    for (size_t i = 0; i < found.size(); ++i) {
+        heap.push(found[i].score, found[i].id);
+    }
+    return heap.take_sorted();
+}
+
+size_t HnswIndex::get_memory_usage() const {
+    size_t total = level0_.capacity() * sizeof(uint32_t);
+    total += levels_.capacity() * sizeof(int);
+    total += upper_.capacity() * sizeof(std::vector<uint32_t>);
+    for (size_t i = 0; i < upper_.size(); ++i) {
+        total += upper_[i].capacity() * sizeof(uint32_t);
+    }
+    return total;
+}
+
+void HnswIndex::save(BinaryWriter& out) const {
+    out.write_pod(config_);
+    out.write_pod(entry_point_);
+    out.write_pod(max_level_);
+    out.write_vector(level0_);
+    out.write_vector(levels_);
+    // 上层邻接表按节点顺序拼接，各节点长度由 levels_ 推出
+    uint64_t upper_total = 0;
+    for (size_t i = 0; i < upper_.size(); ++i) upper_total += upper_[i].size();
+    out.write_pod(upper_total);
+    for (size_t i = 0; i < upper_.size(); ++i) {
+        out.write(upper_[i].data(), upper_[i].size() * sizeof(uint32_t));
+    }
+}
+
+bool HnswIndex::load(BinaryReader& in) {
+    clear();
+    HnswConfig config;
+    uint64_t upper_total = 0;
+    if (!in.read_pod(config) || !in.read_pod(entry_point_) || !in.read_pod(max_level_) ||
+        !in.read_vector(level0_) || !in.read_vector(levels_) || !in.read_pod(upper_total)) {
+        clear();
+        return false;
+    }
+    configure(config);
+
+    // 校验结构尺寸、层数与入口点，防止损坏的文件导致越界访问或超大内存分配（须在分配上层邻接表之前完成）
+    const size_t count = levels_.size();
+    const size_t stride0 = max_links0_ + 1;
+    const size_t stride = max_links_ + 1;
+    bool valid = level0_.size() % stride0 == 0 && level0_.size() / stride0 == count;
+    if (count == 0) {
+        valid = valid && max_level_ == -1 && upper_total == 0;
+    } else {
+        valid = valid && max_level_ >= 0 && max_level_ <= kMaxLevel &&
+                entry_point_ < count && levels_[entry_point_] == max_level_;
+    }
+    uint64_t level_sum = 0;
+    for (size_t i = 0; valid && i < count; ++i) {
+        valid = levels_[i] >= 0 && levels_[i] <= max_level_;
+        level_sum += static_cast<uint64_t>(levels_[i]);
+    }
+    // 上层邻接表总长必须恰为 sum(levels) * (M + 1)，且不超过剩余数据量
+    valid = valid && upper_total % stride == 0 && upper_total / stride == level_sum &&
+            upper_total <= in.remaining() / sizeof(uint32_t);
+    if (!valid) {
+        clear();
+        return false;
+    }
+    upper_.resize(count);
+    for (size_t i = 0; valid && i < count; ++i) {
+        upper_[i].resize(static_cast<size_t>(levels_[i]) * (max_links_ + 1));
+        valid = in.read(upper_[i].data(), upper_[i].size() * sizeof(uint32_t));
+    }
+    for (size_t i = 0; valid && i < count; ++i) {
+        for (int level = 0; valid && level <= levels_[i]; ++level) {
+            const uint32_t* node_links = links(static_cast<uint32_t>(i), level);
+            size_t capacity = level == 0 ? max_links0_ : max_links_;
+            valid = node_links[0] <= capacity;
+            for (uint32_t j = 1; valid && j <= node_links[0]; ++j) {
+                valid = node_links[j] < count;
+            }
+        }
+    }
+    if (!valid) {
+        clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,210 @@
+#include "../include/IvfIndex.h"
+#include "../include/ThreadPool.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// 分配阶段每个并行任务处理的行数
+const size_t kAssignChunk = 1024;
+
+} // namespace
+
+IvfIndex::IvfIndex() : dim_(0), stride_(0), count_(0) {}
+
+void IvfIndex::clear() {
+    centroids_.clear();
+    lists_.clear();
+    dim_ = 0;
+    stride_ = 0;
+    count_ = 0;
+}
+
+size_t IvfIndex::nearest_centroid(const float* vec, std::vector<float>& scores) const {
+    size_t nlist = lists_.size();
+    scores.resize(nlist);
+    VectorOps::dot_rows(vec, centroids_.data(), stride_, nlist, dim_, scores.data());
+    return static_cast<size_t>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+}
+
+void IvfIndex::assign_rows(const VectorView& vectors, const uint32_t* ids, size_t count,
+                           uint32_t* assignment, ThreadPool* pool) const {
+    size_t chunks = (count + kAssignChunk - 1) / kAssignChunk;
+    auto run_chunk = [&](size_t c) {
+        std::vector<float> scores;
+        size_t end = std::min(count, (c + 1) * kAssignChunk);
+        for (size_t i = c * kAssignChunk; i < end; ++i) {
+            const float* vec = vectors.row(ids ? ids[i] : i);
+            assignment[i] = static_cast<uint32_t>(nearest_centroid(vec, scores));
+        }
+    };
+    if (pool) {
+        pool->parallel_for(chunks, run_chunk);
+    } else {
+        for (size_t c = 0; c < chunks; ++c) run_chunk(c);
+    }
+}
+
+void IvfIndex::build(const VectorView& vectors, size_t count, const IvfConfig& config, ThreadPool* pool) {
+    clear();
+    config_ = config;
+    if (count == 0) return;
+
+    dim_ = vectors.dim;
+    stride_ = vectors.stride;
+    size_t nlist = config.nlist > 0 ? static_cast<size_t>(config.nlist)
+                                    : static_cast<size_t>(std::sqrt(static_cast<double>(count)));
+    nlist = std::max<size_t>(1, std::min(nlist, count));
+
+    // 1. 采样训练集（部分 Fisher-Yates 洗牌，种子固定以保证可复现）
+    std::mt19937 rng(1234);
+    size_t max_samples = nlist * static_cast<size_t>(std::max(1, config.max_samples_per_list));
+    size_t num_samples = std::min(count, std::max(max_samples, nlist));
+    std::vector<uint32_t> samples(count);
+    for (size_t i = 0; i < count; ++i) samples[i] = static_cast<uint32_t>(i);
+    for (size_t i = 0; i < num_samples; ++i) {
+        std::uniform_int_distribution<size_t> pick(i, count - 1);
+        std::swap(samples[i], samples[pick(rng)]);
+    }
+    samples.resize(num_samples);
+
+    // 2. 以前 nlist 个样本初始化中心
+    centroids_.assign(nlist * stride_, 0.0f);
+    lists_.resize(nlist);
+    for (size_t c = 0; c < nlist; ++c) {
+        std::copy(vectors.row(samples[c]), vectors.row(samples[c]) + dim_, centroids_.data() + c * stride_);
+    }
+
+    // 3. 球面 k-means：按内积分配，中心取均值后重新归一化
+    std::vector<uint32_t> assignment(num_samples);
+    std::vector<double> sums(nlist * dim_);
+    std::vector<size_t> sizes(nlist);
+    for (int iter = 0; iter < config.train_iterations; ++iter) {
+        assign_rows(vectors, samples.data(), num_samples, assignment.data(), pool);
+
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (size_t i = 0; i < num_samples; ++i) {
+            const float* vec = vectors.row(samples[i]);
+            double* sum = &sums[assignment[i] * dim_];
+            for (size_t d = 0; d < dim_; ++d) sum[d] += vec[d];
+            sizes[assignment[i]]++;
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, num_samples - 1);
+        for (size_t c = 0; c < nlist; ++c) {
+            float* center = centroids_.data() + c * stride_;
+            if (sizes[c] == 0) {
+                // 空簇：用随机样本重新播种
+                const float* vec = vectors.row(samples[pick(rng)]);
+                std::copy(vec, vec + dim_, center);
+                continue;
+            }
+            const double* sum = &sums[c * dim_];
+            for (size_t d = 0; d < dim_; ++d) center[d] = static_cast<float>(sum[d] / sizes[c]);
+            VectorOps::l2_normalize(center, dim_);
+        }
+    }
+
+    // 4. 全量分配建立倒排列表
+    assignment.resize(count);
+    assign_rows(vectors, nullptr, count, assignment.data(), pool);
+    for (size_t i = 0; i < count; ++i) {
+        lists_[assignment[i]].push_back(static_cast<uint32_t>(i));
+    }
+    count_ = count;
+}
+
+void IvfIndex::add(const VectorView& vectors) {
+    if (lists_.empty()) return;
+    std::vector<float> scores;
+    size_t list = nearest_centroid(vectors.row(count_), scores);
+    lists_[list].push_back(static_cast<uint32_t>(count_));
+    count_++;
+}
+
+std::vector<TopKHeap::Entry> IvfIndex::search(const VectorView& vectors, const float* query,
+                                              size_t top_k, size_t nprobe) const {
+    if (count_ == 0 || top_k == 0) {
+        return std::vector<TopKHeap::Entry>();
+    }
+
+    // 1. 选出最相似的 nprobe 个中心
+    size_t nlist = lists_.size();
+    std::vector<float> scores(nlist);
+    VectorOps::dot_rows(query, centroids_.data(), stride_, nlist, dim_, scores.data());
+    TopKHeap probes(std::max<size_t>(1, std::min(nprobe, nlist)));
+    for (size_t c = 0; c < nlist; ++c) {
+        probes.push(scores[c], c);
+    }
+    std::vector<TopKHeap::Entry> lists = probes.take_sorted();
+
+    // 2. 扫描这些列表中的条目
+    TopKHeap heap(top_k);
+    for (size_t p = 0; p < lists.size(); ++p) {
+        const std::vector<uint32_t>& ids = lists_[lists[p].id];
+        for (size_t i = 0; i < ids.size(); ++i) {
+            heap.push(VectorOps::dot(query, vectors.row(ids[i]), dim_), ids[i]);
+        }
+    }
+    return heap.take_sorted();
+}
+
+size_t IvfIndex::get_memory_usage() const {
+    size_t total = centroids_.capacity() * sizeof(float);
+    total += lists_.capacity() * sizeof(std::vector<uint32_t>);
+    for (size_t i = 0; i < lists_.size(); ++i) {
+        total += lists_[i].capacity() * sizeof(uint32_t);
+    }
+    return total;
+}
+
+void IvfIndex::save(BinaryWriter& out) const {
+    out.write_pod(config_);
+    out.write_pod<uint64_t>(dim_);
+    out.write_pod<uint64_t>(stride_);
+    out.write_pod<uint64_t>(count_);
+    out.write_vector(centroids_);
+    out.write_pod<uint64_t>(lists_.size());
+    for (size_t i = 0; i < lists_.size(); ++i) {
+        out.write_vector(lists_[i]);
+    }
+}
+
+bool IvfIndex::load(BinaryReader& in) {
+    clear();
+    uint64_t dim = 0, stride = 0, count = 0, nlist = 0;
+    bool valid = in.read_pod(config_) && in.read_pod(dim) && in.read_pod(stride) && in.read_pod(count) &&
+                 in.read_vector(centroids_) && in.read_pod(nlist) && centroids_.size() == nlist * stride &&
+                 dim <= stride && nlist <= in.remaining() / sizeof(uint64_t);
+    if (valid) {
+        lists_.resize(static_cast<size_t>(nlist));
+    }
+    // 各倒排表须恰好覆盖 [0, count) 中的每个 id 一次，否则检索会返回重复条目或漏掉条目
+    uint64_t total = 0;
+    for (size_t i = 0; valid && i < lists_.size(); ++i) {
+        valid = in.read_vector(lists_[i]);
+        total += lists_[i].size();
+    }
+    valid = valid && total == count;
+    if (valid) {
+        std::vector<bool> seen(static_cast<size_t>(count), false);
+        for (size_t i = 0; valid && i < lists_.size(); ++i) {
+            for (size_t j = 0; valid && j < lists_[i].size(); ++j) {
+                uint32_t id = lists_[i][j];
+                valid = id < count && !seen[id];
+                if (valid) seen[id] = true;
+            }
+        }
+    }
+    if (!valid) {
+        clear();
+        return false;
+    }
+    dim_ = static_cast<size_t>(dim);
+    stride_ = static_cast<size_t>(stride);
+    count_ = static_cast<size_t>(count);
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "../include/Log.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+#ifdef ANDROID
+#include <android/log.h>
+#endif
+
+namespace {
+
+// 单条日志的最大长度，超出部分截断
+const size_t kMaxMessage = 1024;
+
+std::atomic<int> g_level(LOG_LEVEL_DEBUG);
+std::atomic<LogCallback> g_callback(nullptr);
+
+} // namespace
+
+void log_set_level(int level) {
+    g_level.store(level, std::memory_order_relaxed);
+}
+
+bool log_enabled(int level) {
+    return level >= g_level.load(std::memory_order_relaxed);
+}
+
+void log_set_callback(LogCallback callback) {
+    g_callback.store(callback);
+}
+
+void log_write(int level, const char* tag, const char* format, ...) {
+    char message[kMaxMessage];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    LogCallback callback = g_callback.load();
+    if (callback) {
+        callback(level, tag, message);
+        return;
+    }
+#ifdef ANDROID
+    static const int priorities[] = {ANDROID_LOG_DEBUG, ANDROID_LOG_INFO, ANDROID_LOG_WARN, ANDROID_LOG_ERROR};
+    int priority = level >= LOG_LEVEL_DEBUG && level <= LOG_LEVEL_ERROR ? priorities[level] : ANDROID_LOG_ERROR;
+    __android_log_write(priority, tag, message);
+#else
+    static const char names[] = {'D', 'I', 'W', 'E'};
+    char name = level >= LOG_LEVEL_DEBUG && level <= LOG_LEVEL_ERROR ? names[level] : 'E';
+    fprintf(stderr, "%c/%s: %s\n", name, tag, message);
+#endif
+}
@@ -0,0 +1,62 @@
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : data_(nullptr), size_(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // 映射建立后文件描述符即可关闭
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    data_ = static_cast<const char*>(addr);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::advise_random(size_t offset, size_t length) const {
+    if (!data_ || offset >= size_) return;
+    // madvise 要求起始地址按页对齐
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    size_t end = std::min(size_, offset + length);
+    madvise(const_cast<char*>(data_) + begin, end - begin, MADV_RANDOM);
+}
+
+size_t MappedFile::resident_size() const {
+    if (!data_) return 0;
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((size_ + page - 1) / page);
+    if (mincore(const_cast<char*>(data_), size_, pages.data()) != 0) return size_;
+    size_t resident = 0;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i] & 1) resident++;
+    }
+    return std::min(size_, resident * page);
+}
+
+void MappedFile::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
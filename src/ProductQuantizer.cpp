@@ -0,0 +1,243 @@
+#include "../include/ProductQuantizer.h"
+#include "../include/ThreadPool.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// 编码阶段每个并行任务处理的行数
+const size_t kEncodeChunk = 1024;
+
+} // namespace
+
+ProductQuantizer::ProductQuantizer() : dim_(0), m_(0), count_(0) {}
+
+void ProductQuantizer::clear() {
+    offsets_.clear();
+    codebooks_.clear();
+    half_norms_.clear();
+    codes_.clear();
+    dim_ = 0;
+    m_ = 0;
+    count_ = 0;
+}
+
+void ProductQuantizer::subspace_dots(size_t j, const float* sub, float* out) const {
+    // 码本按 [维度, 中心] 转置存放，内层循环沿 256 个中心连续访问，便于编译器向量化
+    const float* cb = codebook(j);
+    size_t dsub = sub_dim(j);
+    std::fill(out, out + kCentroids, 0.0f);
+    for (size_t d = 0; d < dsub; ++d) {
+        float x = sub[d];
+        const float* col = cb + d * kCentroids;
+        for (size_t c = 0; c < kCentroids; ++c) {
+            out[c] += x * col[c];
+        }
+    }
+}
+
+// 最近中心：argmin |x - c|^2 = argmax (x·c - |c|^2 / 2)
+void ProductQuantizer::encode(const float* vec, uint8_t* code, float* scores) const {
+    for (size_t j = 0; j < m_; ++j) {
+        subspace_dots(j, vec + offsets_[j], scores);
+        const float* half_norms = &half_norms_[j * kCentroids];
+        size_t best = 0;
+        float best_score = scores[0] - half_norms[0];
+        for (size_t c = 1; c < kCentroids; ++c) {
+            float score = scores[c] - half_norms[c];
+            if (score > best_score) {
+                best_score = score;
+                best = c;
+            }
+        }
+        code[j] = static_cast<uint8_t>(best);
+    }
+}
+
+void ProductQuantizer::train_subspace(size_t j, const VectorView& vectors, const std::vector<uint32_t>& samples,
+                                      int iterations) {
+    const size_t dsub = sub_dim(j);
+    const size_t offset = offsets_[j];
+    const size_t num_samples = samples.size();
+    float* cb = codebook(j);
+    float* half_norms = &half_norms_[j * kCentroids];
+
+    auto update_norms = [&]() {
+        for (size_t c = 0; c < kCentroids; ++c) {
+            float norm = 0.0f;
+            for (size_t d = 0; d < dsub; ++d) norm += cb[d * kCentroids + c] * cb[d * kCentroids + c];
+            half_norms[c] = 0.5f * norm;
+        }
+    };
+    auto set_center = [&](size_t c, const float* sub) {
+        for (size_t d = 0; d < dsub; ++d) cb[d * kCentroids + c] = sub[d];
+    };
+
+    // 以前 256 个样本初始化中心（样本不足时循环使用，多余的中心在迭代中自然成为空簇）
+    for (size_t c = 0; c < kCentroids; ++c) {
+        set_center(c, vectors.row(samples[c % num_samples]) + offset);
+    }
+    update_norms();
+
+    // 每个子空间使用独立的随机数种子，保证并行训练结果可复现
+    std::mt19937 rng(1234 + static_cast<unsigned>(j));
+    std::uniform_int_distribution<size_t> pick(0, num_samples - 1);
+    std::vector<double> sums(kCentroids * dsub);
+    std::vector<size_t> sizes(kCentroids);
+    float scores[kCentroids];
+    for (int iter = 0; iter < iterations; ++iter) {
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(sizes.begin(), sizes.end(), 0);
+        for (size_t i = 0; i < num_samples; ++i) {
+            const float* sub = vectors.row(samples[i]) + offset;
+            subspace_dots(j, sub, scores);
+            size_t best = 0;
+            float best_score = scores[0] - half_norms[0];
+            for (size_t c = 1; c < kCentroids; ++c) {
+                float score = scores[c] - half_norms[c];
+                if (score > best_score) {
+                    best_score = score;
+                    best = c;
+                }
+            }
+            double* sum = &sums[best * dsub];
+            for (size_t d = 0; d < dsub; ++d) sum[d] += sub[d];
+            sizes[best]++;
+        }
+
+        for (size_t c = 0; c < kCentroids; ++c) {
+            if (sizes[c] == 0) {
+                // 空簇：用随机样本重新播种
+                set_center(c, vectors.row(samples[pick(rng)]) + offset);
+                continue;
+            }
+            for (size_t d = 0; d < dsub; ++d) {
+                cb[d * kCentroids + c] = static_cast<float>(sums[c * dsub + d] / sizes[c]);
+            }
+        }
+        update_norms();
+    }
+}
+
+void ProductQuantizer::build(const VectorView& vectors, size_t count, const PqConfig& config, ThreadPool* pool) {
+    clear();
+    if (count == 0 || vectors.dim == 0) return;
+
+    dim_ = vectors.dim;
+    m_ = config.m > 0 ? std::min(static_cast<size_t>(config.m), dim_) : std::max<size_t>(1, dim_ / 4);
+    offsets_.resize(m_ + 1);
+    for (size_t j = 0; j <= m_; ++j) {
+        offsets_[j] = j * dim_ / m_;
+    }
+    codebooks_.assign(dim_ * kCentroids, 0.0f);
+    half_norms_.assign(m_ * kCentroids, 0.0f);
+
+    // 1. 采样训练集（部分 Fisher-Yates 洗牌，种子固定以保证可复现）
+    std::mt19937 rng(1234);
+    size_t num_samples = std::min(count, static_cast<size_t>(std::max(1, config.max_train_samples)));
+    std::vector<uint32_t> samples(count);
+    for (size_t i = 0; i < count; ++i) samples[i] = static_cast<uint32_t>(i);
+    for (size_t i = 0; i < num_samples; ++i) {
+        std::uniform_int_distribution<size_t> pick(i, count - 1);
+        std::swap(samples[i], samples[pick(rng)]);
+    }
+    samples.resize(num_samples);
+
+    // 2. 各子空间独立训练码本
+    auto train = [&](size_t j) { train_subspace(j, vectors, samples, config.train_iterations); };
+    if (pool) {
+        pool->parallel_for(m_, train);
+    } else {
+        for (size_t j = 0; j < m_; ++j) train(j);
+    }
+
+    // 3. 编码全部行
+    codes_.resize(count * m_);
+    size_t chunks = (count + kEncodeChunk - 1) / kEncodeChunk;
+    auto encode_chunk = [&](size_t c) {
+        float scores[kCentroids];
+        size_t end = std::min(count, (c + 1) * kEncodeChunk);
+        for (size_t i = c * kEncodeChunk; i < end; ++i) {
+            encode(vectors.row(i), &codes_[i * m_], scores);
+        }
+    };
+    if (pool) {
+        pool->parallel_for(chunks, encode_chunk);
+    } else {
+        for (size_t c = 0; c < chunks; ++c) encode_chunk(c);
+    }
+    count_ = count;
+}
+
+void ProductQuantizer::add(const float* vec) {
+    if (m_ == 0) return;
+    float scores[kCentroids];
+    codes_.resize(codes_.size() + m_);
+    encode(vec, &codes_[count_ * m_], scores);
+    count_++;
+}
+
+void ProductQuantizer::compute_table(const float* query, float* table) const {
+    for (size_t j = 0; j < m_; ++j) {
+        subspace_dots(j, query + offsets_[j], table + j * kCentroids);
+    }
+}
+
+void ProductQuantizer::scan(const float* table, size_t begin, size_t end, TopKHeap& heap) const {
+    for (size_t i = begin; i < end; ++i) {
+        const uint8_t* code = &codes_[i * m_];
+        // 四路累加打断查表加法的依赖链
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        size_t j = 0;
+        for (; j + 4 <= m_; j += 4) {
+            s0 += table[j * kCentroids + code[j]];
+            s1 += table[(j + 1) * kCentroids + code[j + 1]];
+            s2 += table[(j + 2) * kCentroids + code[j + 2]];
+            s3 += table[(j + 3) * kCentroids + code[j + 3]];
+        }
+        for (; j < m_; ++j) {
+            s0 += table[j * kCentroids + code[j]];
+        }
+        heap.push((s0 + s1) + (s2 + s3), i);
+    }
+}
+
+size_t ProductQuantizer::get_memory_usage() const {
+    return codebooks_.capacity() * sizeof(float) + half_norms_.capacity() * sizeof(float) +
+           codes_.capacity() + offsets_.capacity() * sizeof(size_t);
+}
+
+void ProductQuantizer::save(BinaryWriter& out) const {
+    out.write_pod<uint64_t>(dim_);
+    out.write_pod<uint64_t>(m_);
+    out.write_pod<uint64_t>(count_);
+    std::vector<uint64_t> offsets(offsets_.begin(), offsets_.end());
+    out.write_vector(offsets);
+    out.write_vector(codebooks_);
+    out.write_vector(half_norms_);
+    out.write_vector(codes_);
+}
+
+bool ProductQuantizer::load(BinaryReader& in) {
+    clear();
+    uint64_t dim = 0, m = 0, count = 0;
+    std::vector<uint64_t> offsets;
+    bool valid = in.read_pod(dim) && in.read_pod(m) && in.read_pod(count) && in.read_vector(offsets) &&
+                 in.read_vector(codebooks_) && in.read_vector(half_norms_) && in.read_vector(codes_);
+    valid = valid && m > 0 && offsets.size() == m + 1 && offsets[0] == 0 && offsets[m] == dim &&
+            codebooks_.size() == dim * kCentroids && half_norms_.size() == m * kCentroids &&
+            codes_.size() == count * m;
+    for (size_t j = 0; valid && j < m; ++j) {
+        valid = offsets[j] <= offsets[j + 1];
+    }
+    if (!valid) {
+        clear();
+        return false;
+    }
+    dim_ = static_cast<size_t>(dim);
+    m_ = static_cast<size_t>(m);
+    count_ = static_cast<size_t>(count);
+    offsets_.assign(offsets.begin(), offsets.end());
+    return true;
+}
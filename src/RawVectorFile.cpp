@@ -0,0 +1,94 @@
+#include "../include/RawVectorFile.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+
+// pread / pwrite 可能只完成部分字节，循环直到全部完成
+bool write_all(int fd, const char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+bool read_all(int fd, char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, data, size, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+} // namespace
+
+RawVectorFile::RawVectorFile() : fd_(-1), dim_(0), count_(0) {}
+
+RawVectorFile::~RawVectorFile() {
+    close();
+}
+
+bool RawVectorFile::create(const std::string& path, size_t dim) {
+    close();
+    if (dim == 0) return false;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) return false;
+    dim_ = dim;
+    path_ = path;
+    return true;
+}
+
+bool RawVectorFile::open(const std::string& path, size_t dim) {
+    close();
+    if (dim == 0) return false;
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return false;
+    struct stat st;
+    size_t row_bytes = dim * sizeof(float);
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) % row_bytes != 0) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    dim_ = dim;
+    count_ = static_cast<size_t>(st.st_size) / row_bytes;
+    path_ = path;
+    return true;
+}
+
+bool RawVectorFile::append(const float* vec) {
+    if (fd_ < 0) return false;
+    size_t row_bytes = dim_ * sizeof(float);
+    if (!write_all(fd_, reinterpret_cast<const char*>(vec), row_bytes, static_cast<off_t>(count_ * row_bytes))) {
+        return false;
+    }
+    count_++;
+    return true;
+}
+
+bool RawVectorFile::read(size_t index, float* out) const {
+    if (fd_ < 0 || index >= count_) return false;
+    size_t row_bytes = dim_ * sizeof(float);
+    return read_all(fd_, reinterpret_cast<char*>(out), row_bytes, static_cast<off_t>(index * row_bytes));
+}
+
+void RawVectorFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    dim_ = 0;
+    count_ = 0;
+    path_.clear();
+}
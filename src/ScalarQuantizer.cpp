@@ -0,0 +1,101 @@
+#include "../include/ScalarQuantizer.h"
+#include "../include/BinaryIO.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 编码行对齐字节数
+const size_t kCodeAlign = 64;
+// 扫描时每块先批量算整数点积再挑选最优
+const size_t kScanBlockRows = 256;
+
+} // namespace
+
+ScalarQuantizer::ScalarQuantizer() : dim_(0), stride_(0), count_(0) {}
+
+void ScalarQuantizer::clear() {
+    codes_.clear();
+    scales_.clear();
+    dim_ = 0;
+    stride_ = 0;
+    count_ = 0;
+}
+
+float ScalarQuantizer::quantize(const float* vec, int8_t* out) const {
+    float max_abs = 0.0f;
+    for (size_t d = 0; d < dim_; ++d) {
+        max_abs = std::max(max_abs, std::fabs(vec[d]));
+    }
+    std::fill(out, out + stride_, static_cast<int8_t>(0));
+    if (max_abs == 0.0f) {
+        return 0.0f;
+    }
+    // 只用 [-127, 127]，保证整数内核中 |a| 可用无符号 8 位表示
+    float inv = 127.0f / max_abs;
+    for (size_t d = 0; d < dim_; ++d) {
+        float q = std::nearbyint(vec[d] * inv);
+        out[d] = static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+    }
+    return max_abs / 127.0f;
+}
+
+void ScalarQuantizer::build(const VectorView& vectors, size_t count) {
+    clear();
+    if (vectors.dim == 0) return;
+    dim_ = vectors.dim;
+    stride_ = (dim_ + kCodeAlign - 1) / kCodeAlign * kCodeAlign;
+    codes_.resize(count * stride_);
+    scales_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        scales_[i] = quantize(vectors.row(i), &codes_[i * stride_]);
+    }
+    count_ = count;
+}
+
+void ScalarQuantizer::add(const float* vec) {
+    if (stride_ == 0) return;
+    codes_.resize(codes_.size() + stride_);
+    scales_.push_back(quantize(vec, &codes_[count_ * stride_]));
+    count_++;
+}
+
+void ScalarQuantizer::scan(const int8_t* query, float query_scale, size_t begin, size_t end, TopKHeap& heap) const {
+    int32_t dots[kScanBlockRows];
+    for (size_t start = begin; start < end; start += kScanBlockRows) {
+        size_t block = std::min(kScanBlockRows, end - start);
+        // 补齐部分为 0，按整行长度计算可省去内核的尾部处理
+        VectorOps::dot_rows_i8(query, &codes_[start * stride_], stride_, block, stride_, dots);
+        for (size_t j = 0; j < block; ++j) {
+            heap.push(query_scale * scales_[start + j] * static_cast<float>(dots[j]), start + j);
+        }
+    }
+}
+
+size_t ScalarQuantizer::get_memory_usage() const {
+    return codes_.capacity() + scales_.capacity() * sizeof(float);
+}
+
+void ScalarQuantizer::save(BinaryWriter& out) const {
+    out.write_pod<uint64_t>(dim_);
+    out.write_pod<uint64_t>(stride_);
+    out.write_pod<uint64_t>(count_);
+    out.write_vector(codes_);
+    out.write_vector(scales_);
+}
+
+bool ScalarQuantizer::load(BinaryReader& in) {
+    clear();
+    uint64_t dim = 0, stride = 0, count = 0;
+    bool valid = in.read_pod(dim) && in.read_pod(stride) && in.read_pod(count) &&
+                 in.read_vector(codes_) && in.read_vector(scales_) &&
+                 dim <= stride && codes_.size() == count * stride && scales_.size() == count;
+    if (!valid) {
+        clear();
+        return false;
+    }
+    dim_ = static_cast<size_t>(dim);
+    stride_ = static_cast<size_t>(stride);
+    count_ = static_cast<size_t>(count);
+    return true;
+}
@@ -1,94 +1,535 @@
 #include "../include/SimilaritySearch.h"
+#include "../include/AlignedAllocator.h"
+#include "../include/VectorOps.h"
+#include "../include/TopKHeap.h"
+#include "../include/ThreadPool.h"
+#include "../include/RawVectorFile.h"
+#include "../include/BinaryIO.h"
+#include "../include/MappedFile.h"
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
+#include <unistd.h>
+
+namespace {
+
+// 索引快照文件：文件头之后为若干分段，未识别的段跳过，END 段结束
+const char kSnapshotMagic[8] = {'W', '2', 'V', 'I', 'D', 'X', '\0', '\0'};
+const uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t metric;
+    uint32_t index_type;
+    uint32_t storage_type;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t key;           // 调用方提供的数据指纹（模型与语料哈希），不匹配时视为过期
+};
+
+enum SnapshotSection {
+    SECTION_QUESTIONS = 1,
+    SECTION_ANSWERS,
+    SECTION_EMBEDDINGS,     // 行对齐的原始矩阵，不带长度前缀（由段长度推出）
+    SECTION_HNSW,
+    SECTION_IVF,
+    SECTION_PQ,
+    SECTION_INT8,
+    SECTION_HALF,
+    SECTION_BINARY,
+    SECTION_END = 0xffffffffu
+};
+
+// 与目标同目录的唯一临时文件名（进程号 + 进程内计数），多个线程或进程同时保存时互不覆盖
+std::string unique_temp_path(const std::string& path) {
+    static std::atomic<unsigned> counter(0);
+    return path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter.fetch_add(1));
+}
+
+// 字符串表：[count: u64] + [offsets: u64 × (count + 1)] + 连续的字符数据，可直接在映射的文件上按下标读取
+struct StringTableView {
+    const uint64_t* offsets;
+    const char* blob;
+    size_t count;
+
+    StringTableView() : offsets(nullptr), blob(nullptr), count(0) {}
+
+    std::string at(size_t i) const {
+        return std::string(blob + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]));
+    }
+};
+
+void write_strings(BinaryWriter& out, const std::vector<std::string>& strings) {
+    uint64_t offset = 0;
+    out.write_pod<uint64_t>(strings.size());
+    for (size_t i = 0; i < strings.size(); i++) {
+        out.write_pod(offset);
+        offset += strings[i].size();
+    }
+    out.write_pod(offset);
+    for (size_t i = 0; i < strings.size(); i++) {
+        out.write(strings[i].data(), strings[i].size());
+    }
+}
+
+void write_strings(BinaryWriter& out, const StringTableView& table) {
+    out.write_pod<uint64_t>(table.count);
+    out.write(table.offsets, (table.count + 1) * sizeof(uint64_t));
+    out.write(table.blob, static_cast<size_t>(table.offsets[table.count]));
+}
+
+// 校验并引用字符串表（不复制），offsets 须单调且不越过段尾
+bool parse_strings(BinaryReader& in, StringTableView& table) {
+    uint64_t count = 0;
+    if (!in.read_pod(count) || count >= in.remaining() / sizeof(uint64_t)) {
+        return false;
+    }
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(in.current());
+    const char* blob = in.current() + (count + 1) * sizeof(uint64_t);
+    if (!in.skip((count + 1) * sizeof(uint64_t)) || offsets[0] != 0 || offsets[count] > in.remaining()) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (offsets[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    table.offsets = offsets;
+    table.blob = blob;
+    table.count = static_cast<size_t>(count);
+    return in.skip(static_cast<size_t>(offsets[count]));
+}
+
+bool read_strings(BinaryReader& in, std::vector<std::string>& strings) {
+    StringTableView table;
+    if (!parse_strings(in, table)) {
+        return false;
+    }
+    strings.clear();
+    strings.reserve(table.count);
+    for (size_t i = 0; i < table.count; i++) {
+        strings.push_back(table.at(i));
+    }
+    return true;
+}
+
+} // namespace
 
 class SimilaritySearch::Impl {
 private:
-    struct QAEntry {
-        std::string question;
-        std::string answer;
-        std::vector<float> embedding;
-        
-        QAEntry(const std::string& q, const std::string& a, const std::vector<float>& e)
-            : question(q), answer(a), embedding(e) {}
-    };
+    // 行对齐单位：每行向量按 16 个 float（64 字节）对齐，补齐部分填 0 不影响点积
+    static constexpr size_t kRowAlignFloats = 16;
+    // 分块扫描的行数：每块先批量算点积再挑选最优，分数缓冲常驻 L1
+    static constexpr size_t kScanBlockRows = 256;
+    // 批量查询的分块大小：查询块 × 语料分块均按 L2 缓存量级选取
+    static constexpr size_t kBatchQueryBlock = 64;
+    static constexpr size_t kBatchTileRows = 128;
+    // 低于该条数时单线程扫描更快（线程调度开销大于收益）
+    static constexpr size_t kDefaultParallelThreshold = 20000;
+    // 低于该条数时精确扫描已足够快，optimize() 不建近似索引
+    static constexpr size_t kDefaultAnnThreshold = 10000;
+    // 二值编码未设置重排候选数时的默认值
+    static constexpr size_t kDefaultBinaryRerank = 256;
+
+    // 结构数组（SoA）存储：文本与向量分开存放，扫描时只顺序读取连续的向量矩阵
+    std::vector<std::string> questions_;
+    std::vector<std::string> answers_;
+    AlignedFloatVector embeddings_;   // 行主序 [size, row_stride_]
     
-    std::vector<QAEntry> qa_entries_;
+    // 映射模式（load_mapped）：文本与原始矩阵直接引用映射的快照文件，不复制；
+    // 修改数据（add_qa / optimize）前先复制到上面的内存存储
+    std::unique_ptr<MappedFile> mapped_;
+    StringTableView mapped_questions_;
+    StringTableView mapped_answers_;
+    const float* mapped_matrix_;      // 快照不含原始矩阵时为空
+    size_t row_stride_;
     int embedding_dim_;
+    SimilarityMetric metric_;
     bool initialized_;
     
-    // 计算余弦相似度
-    float cosine_similarity(const std::vector<float>& vec1, const std::vector<float>& vec2) {
-        if (vec1.size() != vec2.size() || vec1.empty()) {
-            return 0.0f;
+    // 可选线程池：语料条数达到 parallel_threshold_ 时分片并行扫描
+    std::unique_ptr<ThreadPool> pool_;
+    size_t parallel_threshold_;
+    
+    // 近似最近邻索引，由 optimize() 构建
+    IndexType index_type_;
+    HnswIndex hnsw_;
+    HnswConfig hnsw_config_;
+    IvfIndex ivf_;
+    IvfConfig ivf_config_;
+    size_t ann_threshold_;
+    
+    // 压缩存储，由 optimize() 训练编码；同一时刻只有与 storage_type_ 对应的一种非空
+    StorageType storage_type_;
+    ProductQuantizer pq_;
+    PqConfig pq_config_;
+    ScalarQuantizer sq_;
+    HalfVectorStore half_;
+    BinaryCodeStore bin_;
+    
+    // 重排候选数与全精度向量来源（内存矩阵或磁盘文件）
+    size_t rerank_candidates_;
+    std::string raw_vector_path_;
+    std::unique_ptr<RawVectorFile> raw_file_;
+    
+    const float* matrix() const {
+        return mapped_ ? mapped_matrix_ : embeddings_.data();
+    }
+    
+    const float* row(size_t index) const {
+        return matrix() + index * row_stride_;
+    }
+    
+    VectorView view() const {
+        VectorView v = { matrix(), row_stride_, static_cast<size_t>(embedding_dim_) };
+        return v;
+    }
+    
+    // 原始矩阵可直接访问（压缩后可能已释放）
+    bool raw_in_memory() const {
+        if (mapped_) {
+            return mapped_matrix_ != nullptr;
+        }
+        return embeddings_.size() == questions_.size() * row_stride_;
+    }
+    
+    size_t compressed_size() const {
+        if (!pq_.empty()) return pq_.size();
+        if (!sq_.empty()) return sq_.size();
+        if (!bin_.empty()) return bin_.size();
+        return half_.size();
+    }
+    
+    // 二值编码的汉明距离只用于筛选候选，始终需要精确重排
+    size_t rerank_count() const {
+        if (rerank_candidates_ == 0 && !bin_.empty()) {
+            return kDefaultBinaryRerank;
+        }
+        return rerank_candidates_;
+    }
+    
+    bool compressed_ready() const {
+        return compressed_size() > 0 && compressed_size() == size();
+    }
+    
+    // 当前索引类型对应的近似索引已构建且覆盖全部条目
+    bool ann_ready() const {
+        switch (index_type_) {
+            case INDEX_HNSW: return !hnsw_.empty() && hnsw_.size() == size();
+            case INDEX_IVF: return !ivf_.empty() && ivf_.size() == size();
+            default: return false;
+        }
+    }
+    
+    std::vector<TopKHeap::Entry> ann_search(const float* query, size_t k) const {
+        if (index_type_ == INDEX_IVF) {
+            return ivf_.search(view(), query, k, static_cast<size_t>(std::max(1, ivf_config_.nprobe)));
+        }
+        return hnsw_.search(view(), query, k, static_cast<size_t>(std::max(1, hnsw_config_.ef_search)));
+    }
+
+    // 余弦度量下查询向量归一化一次（写入 buffer）；归一化内积度量下直接使用原向量
+    const float* prepare_query(const std::vector<float>& query_embedding, std::vector<float>& buffer) const {
+        if (metric_ != METRIC_COSINE) {
+            return query_embedding.data();
+        }
+        buffer = query_embedding;
+        normalize(buffer.data());
+        return buffer.data();
+    }
+    
+    // 近零向量（平方范数 < 1e-9）置零，检索时相似度为 0
+    void normalize(float* vec) const {
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        float norm_sq = VectorOps::squared_norm(vec, dim);
+        if (norm_sq < 1e-9f) {
+            std::fill(vec, vec + dim, 0.0f);
+            return;
+        }
+        VectorOps::scale(vec, dim, 1.0f / std::sqrt(norm_sq));
+    }
+
+    // 扫描 [begin, end) 范围内的行，候选写入 heap
+    void scan_range(const float* query, size_t begin, size_t end, TopKHeap& heap) const {
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        float scores[kScanBlockRows];
+        for (size_t start = begin; start < end; start += kScanBlockRows) {
+            size_t block = std::min(kScanBlockRows, end - start);
+            VectorOps::dot_rows(query, row(start), row_stride_, block, dim, scores);
+            for (size_t j = 0; j < block; j++) {
+                heap.push(scores[j], start + j);
+            }
+        }
+    }
+    
+    bool use_parallel(size_t count) const {
+        return pool_ && count >= parallel_threshold_;
+    }
+    
+    // 对 [0, count) 执行 scan(begin, end, heap)；并行时按线程数切分为若干分片（边界对齐到扫描块），
+    // 各分片独立取 top_k 后合并
+    template <typename ScanRange>
+    std::vector<TopKHeap::Entry> scan_sharded(size_t count, size_t k, bool parallel, ScanRange scan) const {
+        if (!parallel) {
+            TopKHeap heap(k);
+            scan(0, count, heap);
+            return heap.take_sorted();
         }
         
-        float dot_product = 0.0f;
-        float norm1 = 0.0f;
-        float norm2 = 0.0f;
+        size_t total_blocks = (count + kScanBlockRows - 1) / kScanBlockRows;
+        size_t shards = std::min(pool_->num_threads() + 1, total_blocks);
+        size_t blocks_per_shard = (total_blocks + shards - 1) / shards;
+        std::vector<TopKHeap> shard_heaps(shards, TopKHeap(k));
+        pool_->parallel_for(shards, [&](size_t shard) {
+            size_t begin = std::min(count, shard * blocks_per_shard * kScanBlockRows);
+            size_t end = std::min(count, begin + blocks_per_shard * kScanBlockRows);
+            scan(begin, end, shard_heaps[shard]);
+        });
         
-        for (size_t i = 0; i < vec1.size(); i++) {
-            dot_product += vec1[i] * vec2[i];
-            norm1 += vec1[i] * vec1[i];
-            norm2 += vec2[i] * vec2[i];
+        TopKHeap heap(k);
+        for (size_t i = 0; i < shards; i++) {
+            heap.merge(shard_heaps[i]);
         }
+        return heap.take_sorted();
+    }
+    
+    // 压缩编码检索：按估算得分取 max(k, rerank_count()) 个候选，需要时再精确重排
+    std::vector<TopKHeap::Entry> compressed_search(const float* query, size_t k, bool parallel) const {
+        const size_t count = size();
+        const size_t rerank_k = rerank_count();
+        size_t candidates = std::min(count, std::max(k, rerank_k));
+        std::vector<TopKHeap::Entry> found;
+        if (!pq_.empty()) {
+            std::vector<float> table(pq_.table_size());
+            pq_.compute_table(query, table.data());
+            found = scan_sharded(count, candidates, parallel,
+                [&](size_t begin, size_t end, TopKHeap& heap) { pq_.scan(table.data(), begin, end, heap); });
+        } else if (!sq_.empty()) {
+            std::vector<int8_t, AlignedAllocator<int8_t, 64> > codes(sq_.code_stride());
+            float scale = sq_.quantize(query, codes.data());
+            found = scan_sharded(count, candidates, parallel,
+                [&](size_t begin, size_t end, TopKHeap& heap) { sq_.scan(codes.data(), scale, begin, end, heap); });
+        } else if (!bin_.empty()) {
+            std::vector<uint64_t> code(bin_.code_words());
+            bin_.encode(query, code.data());
+            found = scan_sharded(count, candidates, parallel,
+                [&](size_t begin, size_t end, TopKHeap& heap) { bin_.scan(code.data(), begin, end, heap); });
+        } else {
+            found = scan_sharded(count, candidates, parallel,
+                [&](size_t begin, size_t end, TopKHeap& heap) { half_.scan(query, begin, end, heap); });
+        }
+        if (rerank_k == 0) {
+            return found;
+        }
+        return rerank(query, found, k);
+    }
+    
+    // 用全精度向量对候选重新打分；取不到原始向量的候选保留压缩得分
+    std::vector<TopKHeap::Entry> rerank(const float* query, const std::vector<TopKHeap::Entry>& candidates,
+                                        size_t k) const {
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        const bool in_memory = raw_in_memory();
+        std::vector<float> buffer(dim);
+        TopKHeap heap(k);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            size_t id = candidates[i].id;
+            float score = candidates[i].score;
+            if (in_memory) {
+                score = VectorOps::dot(query, row(id), dim);
+            } else if (raw_file_ && raw_file_->read(id, buffer.data())) {
+                score = VectorOps::dot(query, buffer.data(), dim);
+            }
+            heap.push(score, id);
+        }
+        return heap.take_sorted();
+    }
+    
+    // 线性扫描，返回得分最高的 top_k 个候选（降序）
+    std::vector<TopKHeap::Entry> scan_top_k(const std::vector<float>& query_embedding, size_t top_k) const {
+        if (size() == 0 || !initialized_ || top_k == 0 ||
+            query_embedding.size() != static_cast<size_t>(embedding_dim_)) {
+            return std::vector<TopKHeap::Entry>();
+        }
+        
+        std::vector<float> normalized_query;
+        const float* query = prepare_query(query_embedding, normalized_query);
+        const size_t count = size();
+        const size_t k = std::min(top_k, count);
         
-        if (norm1 < 1e-9f || norm2 < 1e-9f) {
-            return 0.0f;
+        if (compressed_ready()) {
+            return compressed_search(query, k, use_parallel(count));
+        }
+        if (ann_ready()) {
+            return ann_search(query, k);
         }
         
-        return dot_product / (std::sqrt(norm1) * std::sqrt(norm2));
+        // 入库向量与查询向量均已归一化，余弦相似度即为内积
+        return scan_sharded(count, k, use_parallel(count),
+            [&](size_t begin, size_t end, TopKHeap& heap) { scan_range(query, begin, end, heap); });
     }
     
-    // 搜索单个查询
-    SearchResult search_single(const std::vector<float>& query_embedding, int top_k) {
-        if (qa_entries_.empty() || !initialized_) {
-            return SearchResult("", "", 0.0f);
+    // 对一个查询块执行分块矩阵乘：块内查询打包成连续矩阵，逐个语料分块计算并更新各自的 top_k
+    void scan_query_block(const std::vector<std::vector<float> >& query_embeddings,
+                          const size_t* query_ids, size_t nq, size_t k,
+                          std::vector<std::vector<TopKHeap::Entry> >& results) const {
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        const size_t count = size();
+        
+        AlignedFloatVector packed(nq * row_stride_, 0.0f);
+        std::vector<float> scores(nq * kBatchTileRows);
+        std::vector<TopKHeap> heaps(nq, TopKHeap(k));
+        
+        // 将查询打包为与语料同样行距的连续矩阵，余弦度量下顺带归一化
+        for (size_t i = 0; i < nq; i++) {
+            const std::vector<float>& query = query_embeddings[query_ids[i]];
+            float* dst = packed.data() + i * row_stride_;
+            std::copy(query.begin(), query.end(), dst);
+            if (metric_ == METRIC_COSINE) {
+                normalize(dst);
+            }
         }
         
-        // 使用简单的线性搜索（对于小规模数据足够）
-        // 对于大规模数据，可以考虑使用更高效的数据结构
-        float best_similarity = -1.0f;
-        size_t best_index = 0;
+        for (size_t start = 0; start < count; start += kBatchTileRows) {
+            size_t nr = std::min(kBatchTileRows, count - start);
+            VectorOps::dot_block(packed.data(), row_stride_, nq, row(start), row_stride_, nr,
+                                 dim, scores.data(), kBatchTileRows);
+            for (size_t i = 0; i < nq; i++) {
+                const float* query_scores = scores.data() + i * kBatchTileRows;
+                for (size_t j = 0; j < nr; j++) {
+                    heaps[i].push(query_scores[j], start + j);
+                }
+            }
+        }
+        
+        for (size_t i = 0; i < nq; i++) {
+            results[query_ids[i]] = heaps[i].take_sorted();
+        }
+    }
+    
+    // 批量扫描：按"查询块 × 语料分块"做分块矩阵乘，每个语料分块从内存读入后被整个查询块复用，
+    // 语料的内存读取次数从"每个查询一次"降为"每个查询块一次"；启用线程池时各查询块并行
+    std::vector<std::vector<TopKHeap::Entry> > scan_batch_top_k(const std::vector<std::vector<float> >& query_embeddings,
+                                                               size_t top_k) const {
+        std::vector<std::vector<TopKHeap::Entry> > results(query_embeddings.size());
+        if (size() == 0 || !initialized_ || top_k == 0) {
+            return results;
+        }
+        
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        const size_t count = size();
+        const size_t k = std::min(top_k, count);
         
-        for (size_t i = 0; i < qa_entries_.size(); i++) {
-            float similarity = cosine_similarity(query_embedding, qa_entries_[i].embedding);
-            if (similarity > best_similarity) {
-                best_similarity = similarity;
-                best_index = i;
+        // 维度不匹配的查询直接返回空结果
+        std::vector<size_t> valid;
+        valid.reserve(query_embeddings.size());
+        for (size_t i = 0; i < query_embeddings.size(); i++) {
+            if (query_embeddings[i].size() == dim) {
+                valid.push_back(i);
             }
         }
+        if (valid.empty()) {
+            return results;
+        }
         
-        if (best_similarity < -1.0f) {
-            return SearchResult("", "", 0.0f);
+        // 压缩编码与近似索引按查询逐个检索，启用线程池时各查询并行
+        const bool compressed = compressed_ready();
+        if (compressed || ann_ready()) {
+            auto run_query = [&](size_t i) {
+                std::vector<float> normalized_query;
+                const float* query = prepare_query(query_embeddings[valid[i]], normalized_query);
+                results[valid[i]] = compressed ? compressed_search(query, k, false) : ann_search(query, k);
+            };
+            if (pool_) {
+                pool_->parallel_for(valid.size(), run_query);
+            } else {
+                for (size_t i = 0; i < valid.size(); i++) {
+                    run_query(i);
+                }
+            }
+            return results;
         }
         
-        // 直接使用原始余弦相似度 [-1, 1]
-        // 首先进行裁剪以防止浮点精度问题
-        float final_score = std::max(-1.0f, std::min(1.0f, best_similarity));
+        // 并行时缩小查询块，保证每个线程至少分到一块（块大小保持 4 的倍数以匹配内核）
+        size_t block = kBatchQueryBlock;
+        if (use_parallel(count)) {
+            size_t workers = pool_->num_threads() + 1;
+            size_t per_worker = (valid.size() + workers - 1) / workers;
+            block = std::max<size_t>(4, std::min(block, (per_worker + 3) / 4 * 4));
+        }
+        size_t num_blocks = (valid.size() + block - 1) / block;
         
-        return SearchResult(qa_entries_[best_index].question,
-                          qa_entries_[best_index].answer,
-                          final_score);
+        auto run_block = [&](size_t b) {
+            size_t q_start = b * block;
+            size_t nq = std::min(block, valid.size() - q_start);
+            scan_query_block(query_embeddings, valid.data() + q_start, nq, k, results);
+        };
+        if (use_parallel(count)) {
+            pool_->parallel_for(num_blocks, run_block);
+        } else {
+            for (size_t b = 0; b < num_blocks; b++) {
+                run_block(b);
+            }
+        }
+        return results;
+    }
+    
+    SearchResult make_result(const TopKHeap::Entry& entry) const {
+        // 裁剪到 [-1, 1] 以防止浮点精度问题
+        float final_score = std::max(-1.0f, std::min(1.0f, entry.score));
+        if (mapped_) {
+            return SearchResult(mapped_questions_.at(entry.id), mapped_answers_.at(entry.id), final_score,
+                                static_cast<int64_t>(entry.id));
+        }
+        return SearchResult(questions_[entry.id], answers_[entry.id], final_score, static_cast<int64_t>(entry.id));
+    }
+    
+    // 搜索单个查询
+    SearchResult search_single(const std::vector<float>& query_embedding) const {
+        std::vector<TopKHeap::Entry> best = scan_top_k(query_embedding, 1);
+        if (best.empty()) {
+            return SearchResult("", "", 0.0f);
+        }
+        return make_result(best[0]);
+    }
+    
+    std::vector<SearchResult> make_results(const std::vector<TopKHeap::Entry>& entries) const {
+        std::vector<SearchResult> results;
+        results.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            results.push_back(make_result(entries[i]));
+        }
+        return results;
     }
 
 public:
-    Impl() : embedding_dim_(0), initialized_(false) {}
+    Impl() : mapped_matrix_(nullptr), row_stride_(0), embedding_dim_(0), metric_(METRIC_COSINE), initialized_(false),
+             parallel_threshold_(kDefaultParallelThreshold), index_type_(INDEX_HNSW),
+             ann_threshold_(kDefaultAnnThreshold), storage_type_(STORAGE_FLOAT32), rerank_candidates_(0) {}
     
     ~Impl() {
         clear();
     }
     
-    bool initialize(int embedding_dim) {
+    bool initialize(int embedding_dim, SimilarityMetric metric) {
         if (embedding_dim <= 0) {
             return false;
         }
         
+        // 维度或度量变化时已有矩阵失效，需要清空
+        if (embedding_dim != embedding_dim_ || metric != metric_) {
+            clear();
+        }
         embedding_dim_ = embedding_dim;
+        metric_ = metric;
+        row_stride_ = (static_cast<size_t>(embedding_dim) + kRowAlignFloats - 1) / kRowAlignFloats * kRowAlignFloats;
         initialized_ = true;
         return true;
     }
@@ -97,8 +538,50 @@ public:
         if (!initialized_ || embedding.size() != static_cast<size_t>(embedding_dim_)) {
             return false;
         }
+        detach();
+        
+        float* vec;
+        std::vector<float> buffer;
+        if (raw_in_memory()) {
+            size_t offset = embeddings_.size();
+            embeddings_.resize(offset + row_stride_, 0.0f);
+            vec = embeddings_.data() + offset;
+        } else {
+            // 原始矩阵已释放：只在临时缓冲中归一化，随后写入编码与原始向量文件
+            buffer.assign(row_stride_, 0.0f);
+            vec = buffer.data();
+        }
+        std::copy(embedding.begin(), embedding.end(), vec);
+        if (metric_ == METRIC_COSINE) {
+            normalize(vec);
+        }
+        questions_.push_back(question);
+        answers_.push_back(answer);
         
-        qa_entries_.emplace_back(question, answer, embedding);
+        if (!pq_.empty()) {
+            pq_.add(vec);
+        }
+        if (!sq_.empty()) {
+            sq_.add(vec);
+        }
+        if (!half_.empty()) {
+            half_.add(vec);
+        }
+        if (!bin_.empty()) {
+            bin_.add(vec);
+        }
+        // 追加失败后文件行号与条目不再对应，放弃文件重排
+        if (raw_file_ && !raw_file_->append(vec)) {
+            raw_file_.reset();
+        }
+        
+        // 索引已构建时增量插入
+        if (!hnsw_.empty()) {
+            hnsw_.add(view());
+        }
+        if (!ivf_.empty()) {
+            ivf_.add(view());
+        }
         return true;
     }
     
@@ -109,11 +592,20 @@ public:
             return false;
         }
         
-        for (size_t i = 0; i < questions.size(); i++) {
+        for (size_t i = 0; i < embeddings.size(); i++) {
             if (embeddings[i].size() != static_cast<size_t>(embedding_dim_)) {
                 return false;
             }
-            
+        }
+        
+        // 一次性预留空间，避免矩阵逐行扩容时反复搬移
+        detach();
+        if (raw_in_memory()) {
+            embeddings_.reserve(embeddings_.size() + questions.size() * row_stride_);
+        }
+        questions_.reserve(questions_.size() + questions.size());
+        answers_.reserve(answers_.size() + answers.size());
+        for (size_t i = 0; i < questions.size(); i++) {
             if (!add_qa(questions[i], answers[i], embeddings[i])) {
                 return false;
             }
@@ -123,7 +615,7 @@ public:
     }
     
     SearchResult search(const std::vector<float>& query_embedding, int top_k) {
-        return search_single(query_embedding, top_k);
+        return search_single(query_embedding);
     }
     
     std::vector<SearchResult> search_batch(const std::vector<std::vector<float> >& query_embeddings, int top_k) {
@@ -132,27 +624,399 @@ public:
             return results;
         }
         
-        results.reserve(query_embeddings.size());
-        for (const auto& embedding : query_embeddings) {
-            results.push_back(search_single(embedding, top_k));
+        std::vector<std::vector<TopKHeap::Entry> > best = scan_batch_top_k(query_embeddings, 1);
+        results.reserve(best.size());
+        for (size_t i = 0; i < best.size(); i++) {
+            results.push_back(best[i].empty() ? SearchResult("", "", 0.0f) : make_result(best[i][0]));
+        }
+        
+        return results;
+    }
+    
+    std::vector<SearchResult> search_top_k(const std::vector<float>& query_embedding, int top_k) {
+        if (top_k <= 0) {
+            return std::vector<SearchResult>();
+        }
+        return make_results(scan_top_k(query_embedding, static_cast<size_t>(top_k)));
+    }
+    
+    std::vector<std::vector<SearchResult> > search_batch_top_k(const std::vector<std::vector<float> >& query_embeddings, int top_k) {
+        std::vector<std::vector<SearchResult> > results;
+        if (!initialized_) {
+            return results;
+        }
+        
+        if (top_k <= 0) {
+            results.resize(query_embeddings.size());
+            return results;
+        }
+        
+        std::vector<std::vector<TopKHeap::Entry> > entries = scan_batch_top_k(query_embeddings, static_cast<size_t>(top_k));
+        results.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++) {
+            results.push_back(make_results(entries[i]));
         }
         
         return results;
     }
     
     size_t size() const {
-        return qa_entries_.size();
+        return mapped_ ? mapped_questions_.count : questions_.size();
+    }
+    
+    SimilarityMetric metric() const {
+        return metric_;
+    }
+    
+    void set_num_threads(int num_threads) {
+        if (num_threads <= 1) {
+            pool_.reset();
+        } else if (!pool_ || pool_->num_threads() + 1 != static_cast<size_t>(num_threads)) {
+            // 调用线程也参与扫描，因此后台线程数为 num_threads - 1
+            pool_.reset(new ThreadPool(static_cast<size_t>(num_threads) - 1));
+        }
+    }
+    
+    void set_parallel_threshold(size_t min_entries) {
+        parallel_threshold_ = min_entries;
+    }
+    
+    void set_index_type(IndexType type) {
+        index_type_ = type;
+    }
+    
+    void set_hnsw_config(const HnswConfig& config) {
+        hnsw_config_ = config;
+    }
+    
+    void set_ivf_config(const IvfConfig& config) {
+        ivf_config_ = config;
+    }
+    
+    void set_ann_threshold(size_t min_entries) {
+        ann_threshold_ = min_entries;
+    }
+    
+    void set_storage_type(StorageType type) {
+        storage_type_ = type;
+    }
+    
+    void set_pq_config(const PqConfig& config) {
+        pq_config_ = config;
+    }
+    
+    void set_rerank(size_t candidates, const std::string& raw_vector_path) {
+        rerank_candidates_ = candidates;
+        raw_vector_path_ = raw_vector_path;
     }
     
     void clear() {
-        qa_entries_.clear();
+        questions_.clear();
+        answers_.clear();
+        embeddings_.clear();
+        unmap();
+        hnsw_.clear();
+        ivf_.clear();
+        pq_.clear();
+        sq_.clear();
+        half_.clear();
+        bin_.clear();
+        raw_file_.reset();
+        row_stride_ = 0;
         embedding_dim_ = 0;
         initialized_ = false;
     }
     
+    // 训练压缩编码；需要重排且指定了文件时原始向量落盘，之后释放内存中的原始矩阵
+    void compress() {
+        const size_t count = size();
+        if (count == 0 || !raw_in_memory()) {
+            // 原始矩阵已释放时无法重新训练，保留现有编码
+            return;
+        }
+        
+        pq_.clear();
+        sq_.clear();
+        half_.clear();
+        bin_.clear();
+        if (storage_type_ == STORAGE_PQ) {
+            pq_.build(view(), count, pq_config_, pool_.get());
+        } else if (storage_type_ == STORAGE_INT8) {
+            sq_.build(view(), count);
+        } else if (storage_type_ == STORAGE_BINARY) {
+            bin_.build(view(), count);
+        } else {
+            half_.build(view(), count, storage_type_ == STORAGE_FP16 ? HALF_FP16 : HALF_BF16);
+        }
+        raw_file_.reset();
+        if (rerank_count() > 0 && !raw_vector_path_.empty()) {
+            std::unique_ptr<RawVectorFile> file(new RawVectorFile());
+            bool ok = file->create(raw_vector_path_, static_cast<size_t>(embedding_dim_));
+            for (size_t i = 0; ok && i < count; i++) {
+                ok = file->append(row(i));
+            }
+            if (ok) {
+                raw_file_ = std::move(file);
+            } else {
+                std::cerr << "写入原始向量文件失败，原始向量保留在内存中: " << raw_vector_path_ << std::endl;
+            }
+        }
+        
+        if (rerank_count() == 0 || raw_file_) {
+            AlignedFloatVector().swap(embeddings_);
+        }
+    }
+    
+    // 映射模式下把文本与原始矩阵复制到内存并解除映射，之后可按常规方式修改
+    void detach() {
+        if (!mapped_) {
+            return;
+        }
+        const size_t count = size();
+        questions_.clear();
+        answers_.clear();
+        questions_.reserve(count);
+        answers_.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            questions_.push_back(mapped_questions_.at(i));
+            answers_.push_back(mapped_answers_.at(i));
+        }
+        if (mapped_matrix_) {
+            embeddings_.assign(mapped_matrix_, mapped_matrix_ + count * row_stride_);
+        } else {
+            embeddings_.clear();
+        }
+        unmap();
+    }
+    
+    void unmap() {
+        mapped_.reset();
+        mapped_questions_ = StringTableView();
+        mapped_answers_ = StringTableView();
+        mapped_matrix_ = nullptr;
+    }
+    
+    bool save(const std::string& path, uint64_t key) const {
+        if (!initialized_) {
+            return false;
+        }
+        
+        // 先写临时文件再原子替换：其他进程可能正映射着旧快照，直接截断会使其访问失效
+        const std::string tmp_path = unique_temp_path(path);
+        BinaryWriter out(tmp_path);
+        if (!out.ok()) {
+            std::cerr << "无法写入索引快照: " << tmp_path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        SnapshotHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+        header.version = kSnapshotVersion;
+        header.dim = static_cast<uint32_t>(embedding_dim_);
+        header.metric = static_cast<uint32_t>(metric_);
+        header.index_type = static_cast<uint32_t>(index_type_);
+        header.storage_type = static_cast<uint32_t>(storage_type_);
+        header.count = size();
+        header.key = key;
+        out.write_pod(header);
+        
+        out.begin_section(SECTION_QUESTIONS);
+        if (mapped_) {
+            write_strings(out, mapped_questions_);
+        } else {
+            write_strings(out, questions_);
+        }
+        out.end_section();
+        out.begin_section(SECTION_ANSWERS);
+        if (mapped_) {
+            write_strings(out, mapped_answers_);
+        } else {
+            write_strings(out, answers_);
+        }
+        out.end_section();
+        // 原始矩阵已释放（压缩存储）时只保存编码，重排向量由原始向量文件提供
+        if (raw_in_memory()) {
+            out.begin_section(SECTION_EMBEDDINGS);
+            out.write(matrix(), size() * row_stride_ * sizeof(float));
+            out.end_section();
+        }
+        if (!hnsw_.empty()) {
+            out.begin_section(SECTION_HNSW);
+            hnsw_.save(out);
+            out.end_section();
+        }
+        if (!ivf_.empty()) {
+            out.begin_section(SECTION_IVF);
+            ivf_.save(out);
+            out.end_section();
+        }
+        if (!pq_.empty()) {
+            out.begin_section(SECTION_PQ);
+            pq_.save(out);
+            out.end_section();
+        }
+        if (!sq_.empty()) {
+            out.begin_section(SECTION_INT8);
+            sq_.save(out);
+            out.end_section();
+        }
+        if (!half_.empty()) {
+            out.begin_section(SECTION_HALF);
+            half_.save(out);
+            out.end_section();
+        }
+        if (!bin_.empty()) {
+            out.begin_section(SECTION_BINARY);
+            bin_.save(out);
+            out.end_section();
+        }
+        out.begin_section(SECTION_END);
+        out.end_section();
+        
+        if (!out.close() || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            std::cerr << "写入索引快照失败: " << path << std::endl;
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+    // 文件头不匹配（不存在、版本或 key 不同）时不改动当前数据；段数据损坏时清空并保持已初始化状态。
+    // mapped 为 true 时文本与原始矩阵留在映射的文件中，其余结构仍复制到内存
+    bool load(const std::string& path, uint64_t key, bool mapped) {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        if (!file->open(path)) {
+            return false;
+        }
+        BinaryReader in(file->data(), file->size());
+        SnapshotHeader header;
+        if (!in.read_pod(header) || std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSnapshotVersion || header.key != key || header.dim == 0 ||
+            header.metric > METRIC_NORMALIZED_INNER_PRODUCT || header.index_type > INDEX_IVF ||
+            header.storage_type > STORAGE_BINARY) {
+            return false;
+        }
+        
+        const int dim = static_cast<int>(header.dim);
+        const SimilarityMetric metric = static_cast<SimilarityMetric>(header.metric);
+        clear();
+        initialize(dim, metric);
+        index_type_ = static_cast<IndexType>(header.index_type);
+        storage_type_ = static_cast<StorageType>(header.storage_type);
+        
+        if (mapped) {
+            mapped_ = std::move(file);
+        }
+        if (!load_sections(in, static_cast<size_t>(header.count))) {
+            std::cerr << "索引快照已损坏: " << path << std::endl;
+            clear();
+            initialize(dim, metric);
+            return false;
+        }
+        return true;
+    }
+    
+    bool load_sections(BinaryReader& in, size_t count) {
+        const bool mapped = static_cast<bool>(mapped_);
+        uint32_t id = 0;
+        BinaryReader payload(nullptr, 0);
+        bool ended = false;
+        while (!ended && in.next_section(id, payload)) {
+            bool ok = true;
+            switch (id) {
+                case SECTION_QUESTIONS:
+                    ok = mapped ? parse_strings(payload, mapped_questions_) : read_strings(payload, questions_);
+                    break;
+                case SECTION_ANSWERS:
+                    ok = mapped ? parse_strings(payload, mapped_answers_) : read_strings(payload, answers_);
+                    break;
+                case SECTION_EMBEDDINGS:
+                    ok = payload.remaining() == count * row_stride_ * sizeof(float);
+                    if (ok && mapped) {
+                        // 段数据在文件中按 64 字节对齐，映射基址按页对齐，可直接作为对齐矩阵使用
+                        mapped_matrix_ = reinterpret_cast<const float*>(payload.current());
+                    } else if (ok) {
+                        embeddings_.resize(count * row_stride_);
+                        ok = payload.read(embeddings_.data(), embeddings_.size() * sizeof(float));
+                    }
+                    break;
+                case SECTION_HNSW: ok = hnsw_.load(payload) && hnsw_.size() == count; break;
+                case SECTION_IVF: ok = ivf_.load(payload) && ivf_.size() == count; break;
+                case SECTION_PQ: ok = pq_.load(payload) && pq_.size() == count; break;
+                case SECTION_INT8: ok = sq_.load(payload) && sq_.size() == count; break;
+                case SECTION_HALF: ok = half_.load(payload) && half_.size() == count; break;
+                case SECTION_BINARY: ok = bin_.load(payload) && bin_.size() == count; break;
+                case SECTION_END: ended = true; break;
+                default: break;     // 新版本增加的段：跳过
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        size_t num_answers = mapped ? mapped_answers_.count : answers_.size();
+        if (!ended || size() != count || num_answers != count) {
+            return false;
+        }
+        
+        // 编码维度须与文件头一致
+        const size_t dim = static_cast<size_t>(embedding_dim_);
+        if ((!pq_.empty() && pq_.dim() != dim) || (!sq_.empty() && sq_.dim() != dim) ||
+            (!half_.empty() && half_.dim() != dim) || (!bin_.empty() && bin_.dim() != dim) ||
+            (!ivf_.empty() && ivf_.dim() != dim)) {
+            return false;
+        }
+        
+        if (raw_in_memory()) {
+            return true;
+        }
+        // 原始矩阵未保存：必须有压缩编码，需要重排时重新打开原始向量文件
+        if (!compressed_ready()) {
+            return false;
+        }
+        if (rerank_count() > 0 && !raw_vector_path_.empty()) {
+            std::unique_ptr<RawVectorFile> file(new RawVectorFile());
+            if (file->open(raw_vector_path_, dim) && file->size() == count) {
+                raw_file_ = std::move(file);
+            } else {
+                std::cerr << "原始向量文件与快照不匹配，重排使用压缩得分: " << raw_vector_path_ << std::endl;
+            }
+        }
+        return true;
+    }
+    
     void optimize() {
-        // 这里可以添加优化逻辑，比如构建索引
-        // 对于小规模数据，线性搜索已经足够
+        hnsw_.clear();
+        ivf_.clear();
+        if (!initialized_) {
+            return;
+        }
+        detach();
+        
+        if (storage_type_ != STORAGE_FLOAT32) {
+            compress();
+            return;
+        }
+        if (!raw_in_memory()) {
+            // 原始矩阵已释放，只能继续使用压缩编码
+            return;
+        }
+        pq_.clear();
+        sq_.clear();
+        half_.clear();
+        bin_.clear();
+        raw_file_.reset();
+        
+        if (size() < ann_threshold_) {
+            // 小规模数据线性扫描已经足够
+            return;
+        }
+        
+        if (index_type_ == INDEX_HNSW) {
+            hnsw_.build(view(), size(), hnsw_config_);
+        } else if (index_type_ == INDEX_IVF) {
+            ivf_.build(view(), size(), ivf_config_, pool_.get());
+        }
     }
 };
 
@@ -161,8 +1025,8 @@ SimilaritySearch::SimilaritySearch() : impl_(new Impl()) {}
 
 SimilaritySearch::~SimilaritySearch() {}
 
-bool SimilaritySearch::initialize(int embedding_dim) {
-    return impl_->initialize(embedding_dim);
+bool SimilaritySearch::initialize(int embedding_dim, SimilarityMetric metric) {
+    return impl_->initialize(embedding_dim, metric);
 }
 
 bool SimilaritySearch::add_qa(const std::string& question, const std::string& answer, const std::vector<float>& embedding) {
@@ -183,14 +1047,74 @@ std::vector<SearchResult> SimilaritySearch::search_batch(const std::vector<std::
     return impl_->search_batch(query_embeddings, top_k);
 }
 
+std::vector<SearchResult> SimilaritySearch::search_top_k(const std::vector<float>& query_embedding, int top_k) {
+    return impl_->search_top_k(query_embedding, top_k);
+}
+
+std::vector<std::vector<SearchResult> > SimilaritySearch::search_batch_top_k(const std::vector<std::vector<float> >& query_embeddings, int top_k) {
+    return impl_->search_batch_top_k(query_embeddings, top_k);
+}
+
 size_t SimilaritySearch::size() const {
     return impl_->size();
 }
 
+SimilarityMetric SimilaritySearch::metric() const {
+    return impl_->metric();
+}
+
+void SimilaritySearch::set_num_threads(int num_threads) {
+    impl_->set_num_threads(num_threads);
+}
+
+void SimilaritySearch::set_parallel_threshold(size_t min_entries) {
+    impl_->set_parallel_threshold(min_entries);
+}
+
+void SimilaritySearch::set_index_type(IndexType type) {
+    impl_->set_index_type(type);
+}
+
+void SimilaritySearch::set_hnsw_config(const HnswConfig& config) {
+    impl_->set_hnsw_config(config);
+}
+
+void SimilaritySearch::set_ivf_config(const IvfConfig& config) {
+    impl_->set_ivf_config(config);
+}
+
+void SimilaritySearch::set_ann_threshold(size_t min_entries) {
+    impl_->set_ann_threshold(min_entries);
+}
+
+void SimilaritySearch::set_storage_type(StorageType type) {
+    impl_->set_storage_type(type);
+}
+
+void SimilaritySearch::set_pq_config(const PqConfig& config) {
+    impl_->set_pq_config(config);
+}
+
+void SimilaritySearch::set_rerank(size_t candidates, const std::string& raw_vector_path) {
+    impl_->set_rerank(candidates, raw_vector_path);
+}
+
 void SimilaritySearch::clear() {
     impl_->clear();
 }
 
 void SimilaritySearch::optimize() {
     impl_->optimize();
+}
+
+bool SimilaritySearch::save(const std::string& path, uint64_t key) const {
+    return impl_->save(path, key);
+}
+
+bool SimilaritySearch::load(const std::string& path, uint64_t key) {
+    return impl_->load(path, key, false);
+}
+
+bool SimilaritySearch::load_mapped(const std::string& path, uint64_t key) {
+    return impl_->load(path, key, true);
 }
\ No newline at end of file
@@ -4,17 +4,18 @@
 #include <memory>
 #include <algorithm>
 
-#include <android/log.h>
 #define LOG_TAG "TextEmbedder"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#include "../include/Log.h"
 
 class TextEmbedder::Impl {
 public:
     std::unique_ptr<W2VEmbedder> w2v_ptr;
     std::unique_ptr<BertEmbedder> bert_ptr;
     bool is_bert = false;
+    size_t max_batch_size = 32;
+    BertInputConfig bert_input_config;
 
-    bool initialize(const std::string& model_path, ModelType type) {
+    bool initialize(const std::string& model_path, ModelType type, VectorPrecision precision) {
         LOGI("初始化 Embedder: path=%s, type=%d", model_path.c_str(), type);
         if (type == MODEL_AUTO) {
             if (model_path.find(".onnx") != std::string::npos) {
@@ -27,6 +28,8 @@ public:
         if (type == MODEL_BERT) {
             LOGI("选择 BERT 引擎");
             bert_ptr = std::unique_ptr<BertEmbedder>(new BertEmbedder());
+            bert_ptr->set_max_batch_size(max_batch_size);
+            bert_ptr->set_input_config(bert_input_config);
             std::string vocab_path;
             size_t last_slash = model_path.find_last_of("/\\");
             if (last_slash != std::string::npos) {
@@ -42,7 +45,7 @@ public:
         } else {
             LOGI("选择 Word2Vec 引擎");
             w2v_ptr = std::unique_ptr<W2VEmbedder>(new W2VEmbedder());
-            if (w2v_ptr->initialize(model_path)) {
+            if (w2v_ptr->initialize(model_path, precision)) {
                 is_bert = false;
                 return true;
             }
@@ -53,6 +56,8 @@ public:
     bool initialize_bert(const std::string& model_path, const std::string& vocab_path) {
         LOGI("强制初始化 BERT: model=%s, vocab=%s", model_path.c_str(), vocab_path.c_str());
         bert_ptr = std::unique_ptr<BertEmbedder>(new BertEmbedder());
+        bert_ptr->set_max_batch_size(max_batch_size);
+        bert_ptr->set_input_config(bert_input_config);
         if (bert_ptr->initialize(model_path, vocab_path)) {
             is_bert = true;
             return true;
@@ -65,18 +70,35 @@ public:
             if (bert_ptr) {
                 return bert_ptr->embed(text);
             } else {
-                LOGI("错误: is_bert=true 但 bert_ptr 为空");
+                LOGE("错误: is_bert=true 但 bert_ptr 为空");
             }
         } else {
             if (w2v_ptr) {
                 return w2v_ptr->embed(text);
             } else {
-                LOGI("错误: is_bert=false 但 w2v_ptr 为空");
+                LOGE("错误: is_bert=false 但 w2v_ptr 为空");
             }
         }
         return std::vector<float>();
     }
 
+    std::vector<std::vector<float> > embed_batch(const std::vector<std::string>& texts) {
+        if (is_bert && bert_ptr) {
+            return bert_ptr->embed_batch(texts);
+        }
+        std::vector<std::vector<float> > results;
+        results.reserve(texts.size());
+        for (const auto& text : texts) {
+            results.push_back(embed(text));
+        }
+        return results;
+    }
+
+    void set_max_batch_size(size_t size) {
+        max_batch_size = size;
+        if (bert_ptr) bert_ptr->set_max_batch_size(size);
+    }
+
     int get_embedding_dim() const {
         if (is_bert && bert_ptr) return bert_ptr->get_embedding_dim();
         if (!is_bert && w2v_ptr) return w2v_ptr->get_embedding_dim();
@@ -98,8 +120,8 @@ public:
 TextEmbedder::TextEmbedder() : impl_(std::unique_ptr<Impl>(new Impl())) {}
 TextEmbedder::~TextEmbedder() = default;
 
-bool TextEmbedder::initialize(const std::string& model_path, ModelType type) {
-    return impl_->initialize(model_path, type);
+bool TextEmbedder::initialize(const std::string& model_path, ModelType type, VectorPrecision precision) {
+    return impl_->initialize(model_path, type, precision);
 }
 
 bool TextEmbedder::initialize_bert(const std::string& model_path, const std::string& vocab_path) {
@@ -111,11 +133,15 @@ std::vector<float> TextEmbedder::embed(const std::string& text) {
 }
 
 std::vector<std::vector<float> > TextEmbedder::embed_batch(const std::vector<std::string>& texts) {
-    std::vector<std::vector<float> > results;
-    for (const auto& text : texts) {
-        results.push_back(embed(text));
-    }
-    return results;
+    return impl_->embed_batch(texts);
+}
+
+void TextEmbedder::set_max_batch_size(size_t max_batch_size) {
+    impl_->set_max_batch_size(max_batch_size);
+}
+
+void TextEmbedder::set_bert_input_config(const BertInputConfig& config) {
+    impl_->bert_input_config = config;
 }
 
 int TextEmbedder::get_embedding_dim() const {
@@ -131,5 +157,9 @@ bool TextEmbedder::is_initialized() const {
 }
 
 void TextEmbedder::release() {
+    size_t max_batch_size = impl_->max_batch_size;
+    BertInputConfig bert_input_config = impl_->bert_input_config;
     impl_ = std::unique_ptr<Impl>(new Impl());
+    impl_->max_batch_size = max_batch_size;
+    impl_->bert_input_config = bert_input_config;
 }
@@ -0,0 +1,91 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+// 一次 parallel_for 调用的共享状态，任务下标通过原子计数器动态领取
+struct ParallelBatch {
+    std::atomic<size_t> next;
+    std::atomic<size_t> done;
+    size_t count;
+    const std::function<void(size_t)>* fn;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    ParallelBatch(size_t n, const std::function<void(size_t)>* f) : next(0), done(0), count(n), fn(f) {}
+
+    void run() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < count) {
+            (*fn)(i);
+            if (done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t num_threads) : stopping_(false) {
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.push_back(std::thread(&ThreadPool::worker_loop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i].join();
+    }
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (workers_.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    // 迟到的工作线程领取不到下标时直接返回，不会再访问 fn
+    std::shared_ptr<ParallelBatch> batch = std::make_shared<ParallelBatch>(count, &fn);
+    size_t helpers = std::min(workers_.size(), count - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks_.push_back([batch] { batch->run(); });
+        }
+    }
+    if (helpers == 1) {
+        cv_.notify_one();
+    } else {
+        cv_.notify_all();
+    }
+
+    batch->run();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->cv.wait(lock, [&batch] { return batch->done.load() == batch->count; });
+}
@@ -0,0 +1,914 @@
+#include "../include/VectorOps.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_OPS_X86 1
+// AVX-VNNI 的 target 与 _mm256_dpbusd_avx_epi32 需 GCC 11+，__builtin_cpu_supports("avxvnni") 需 clang 18+；
+// 更早的编译器不编译该内核，int8 点积退回 AVX2
+#if (defined(__clang__) && __clang_major__ >= 18) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 11)
+#define VECTOR_OPS_AVXVNNI 1
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define VECTOR_OPS_NEON 1
+#endif
+
+namespace {
+
+typedef float (*DotFn)(const float*, const float*, size_t);
+typedef void (*DotRowsFn)(const float*, const float*, size_t, size_t, size_t, float*);
+typedef void (*DotBlockFn)(const float*, size_t, size_t, const float*, size_t, size_t, size_t, float*, size_t);
+
+struct Kernels {
+    const char* name;
+    DotFn dot;
+    DotRowsFn dot_rows;
+    DotBlockFn dot_block;
+};
+
+typedef int32_t (*DotI8Fn)(const int8_t*, const int8_t*, size_t);
+
+// int8 内核与浮点内核独立选择（整数点积指令与浮点 SIMD 的支持情况不一致）
+struct Int8Kernels {
+    const char* name;
+    DotI8Fn dot;
+};
+
+typedef float (*DotHalfFn)(const float*, const uint16_t*, size_t);
+typedef void (*AccumulateHalfFn)(float*, const uint16_t*, size_t);
+
+typedef void (*HammingRowsFn)(const uint64_t*, const uint64_t*, size_t, size_t, uint32_t*);
+
+// 二值编码内核（汉明距离）
+struct BitKernels {
+    const char* name;
+    HammingRowsFn hamming_rows;
+};
+
+// 半精度内核：16 位数据在寄存器内转换为 float 后参与计算
+struct HalfKernels {
+    const char* name;
+    DotHalfFn dot_fp16;
+    DotHalfFn dot_bf16;
+    AccumulateHalfFn accumulate_fp16;
+    AccumulateHalfFn accumulate_bf16;
+};
+
+// ---------------- 标量实现 ----------------
+
+float dot_scalar(const float* a, const float* b, size_t n) {
+    // 4 路累加打断依赖链，便于编译器展开
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+void dot_rows_scalar(const float* q, const float* rows, size_t stride, size_t count, size_t n, float* out) {
+    for (size_t r = 0; r < count; ++r) out[r] = dot_scalar(q, rows + r * stride, n);
+}
+
+void dot_block_scalar(const float* queries, size_t q_stride, size_t nq,
+                      const float* rows, size_t r_stride, size_t nr,
+                      size_t n, float* out, size_t out_stride) {
+    for (size_t i = 0; i < nq; ++i) {
+        dot_rows_scalar(queries + i * q_stride, rows, r_stride, nr, n, out + i * out_stride);
+    }
+}
+
+int32_t dot_i8_scalar(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+float dot_fp16_scalar(const float* q, const uint16_t* v, size_t n) {
+    float s0 = 0.0f, s1 = 0.0f;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += q[i] * fp16_to_float(v[i]);
+        s1 += q[i + 1] * fp16_to_float(v[i + 1]);
+    }
+    for (; i < n; ++i) s0 += q[i] * fp16_to_float(v[i]);
+    return s0 + s1;
+}
+
+float dot_bf16_scalar(const float* q, const uint16_t* v, size_t n) {
+    float s0 = 0.0f, s1 = 0.0f;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        s0 += q[i] * bf16_to_float(v[i]);
+        s1 += q[i + 1] * bf16_to_float(v[i + 1]);
+    }
+    for (; i < n; ++i) s0 += q[i] * bf16_to_float(v[i]);
+    return s0 + s1;
+}
+
+void accumulate_fp16_scalar(float* acc, const uint16_t* v, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] += fp16_to_float(v[i]);
+}
+
+void accumulate_bf16_scalar(float* acc, const uint16_t* v, size_t n) {
+    for (size_t i = 0; i < n; ++i) acc[i] += bf16_to_float(v[i]);
+}
+
+// 未开启 popcnt 指令时 __builtin_popcountll 退化为查表实现，x86 上另编译 popcnt 版本按需选用
+void hamming_rows_scalar(const uint64_t* query, const uint64_t* rows, size_t words, size_t count, uint32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint64_t* row = rows + r * words;
+        uint32_t dist = 0;
+        for (size_t w = 0; w < words; ++w) dist += static_cast<uint32_t>(__builtin_popcountll(query[w] ^ row[w]));
+        out[r] = dist;
+    }
+}
+
+#ifdef VECTOR_OPS_X86
+
+// ---------------- SSE ----------------
+
+__attribute__((target("sse2")))
+inline float hsum_sse(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("sse2")))
+float dot_sse(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float sum = hsum_sse(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("sse2")))
+void dot_rows_sse(const float* q, const float* rows, size_t stride, size_t count, size_t n, float* out) {
+    for (size_t r = 0; r < count; ++r) out[r] = dot_sse(q, rows + r * stride, n);
+}
+
+// 4 个查询共享同一行的加载
+__attribute__((target("sse2")))
+void dot4_sse(const float* q0, const float* q1, const float* q2, const float* q3,
+              const float* row, size_t n, float* out) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps(), a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 r = _mm_loadu_ps(row + i);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(q0 + i), r));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(q1 + i), r));
+        a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_loadu_ps(q2 + i), r));
+        a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_loadu_ps(q3 + i), r));
+    }
+    float s0 = hsum_sse(a0), s1 = hsum_sse(a1), s2 = hsum_sse(a2), s3 = hsum_sse(a3);
+    for (; i < n; ++i) {
+        s0 += q0[i] * row[i];
+        s1 += q1[i] * row[i];
+        s2 += q2[i] * row[i];
+        s3 += q3[i] * row[i];
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+__attribute__((target("sse2")))
+void dot_block_sse(const float* queries, size_t q_stride, size_t nq,
+                   const float* rows, size_t r_stride, size_t nr,
+                   size_t n, float* out, size_t out_stride) {
+    size_t i = 0;
+    for (; i + 4 <= nq; i += 4) {
+        const float* q = queries + i * q_stride;
+        float* o = out + i * out_stride;
+        for (size_t r = 0; r < nr; ++r) {
+            float s[4];
+            dot4_sse(q, q + q_stride, q + 2 * q_stride, q + 3 * q_stride, rows + r * r_stride, n, s);
+            o[r] = s[0]; o[out_stride + r] = s[1]; o[2 * out_stride + r] = s[2]; o[3 * out_stride + r] = s[3];
+        }
+    }
+    for (; i < nq; ++i) {
+        dot_rows_sse(queries + i * q_stride, rows, r_stride, nr, n, out + i * out_stride);
+    }
+}
+
+// ---------------- AVX2 + FMA ----------------
+
+__attribute__((target("avx2,fma")))
+inline float hsum_avx(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("avx2,fma")))
+float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+void dot_rows_avx2(const float* q, const float* rows, size_t stride, size_t count, size_t n, float* out) {
+    for (size_t r = 0; r < count; ++r) out[r] = dot_avx2(q, rows + r * stride, n);
+}
+
+__attribute__((target("avx2,fma")))
+void dot4_avx2(const float* q0, const float* q1, const float* q2, const float* q3,
+               const float* row, size_t n, float* out) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 r = _mm256_loadu_ps(row + i);
+        a0 = _mm256_fmadd_ps(_mm256_loadu_ps(q0 + i), r, a0);
+        a1 = _mm256_fmadd_ps(_mm256_loadu_ps(q1 + i), r, a1);
+        a2 = _mm256_fmadd_ps(_mm256_loadu_ps(q2 + i), r, a2);
+        a3 = _mm256_fmadd_ps(_mm256_loadu_ps(q3 + i), r, a3);
+    }
+    float s0 = hsum_avx(a0), s1 = hsum_avx(a1), s2 = hsum_avx(a2), s3 = hsum_avx(a3);
+    for (; i < n; ++i) {
+        s0 += q0[i] * row[i];
+        s1 += q1[i] * row[i];
+        s2 += q2[i] * row[i];
+        s3 += q3[i] * row[i];
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+__attribute__((target("avx2,fma")))
+void dot_block_avx2(const float* queries, size_t q_stride, size_t nq,
+                    const float* rows, size_t r_stride, size_t nr,
+                    size_t n, float* out, size_t out_stride) {
+    size_t i = 0;
+    for (; i + 4 <= nq; i += 4) {
+        const float* q = queries + i * q_stride;
+        float* o = out + i * out_stride;
+        for (size_t r = 0; r < nr; ++r) {
+            float s[4];
+            dot4_avx2(q, q + q_stride, q + 2 * q_stride, q + 3 * q_stride, rows + r * r_stride, n, s);
+            o[r] = s[0]; o[out_stride + r] = s[1]; o[2 * out_stride + r] = s[2]; o[3 * out_stride + r] = s[3];
+        }
+    }
+    for (; i < nq; ++i) {
+        dot_rows_avx2(queries + i * q_stride, rows, r_stride, nr, n, out + i * out_stride);
+    }
+}
+
+// ---------------- AVX-512 ----------------
+
+__attribute__((target("avx512f")))
+float dot_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    if (i < n) {
+        // 尾部用掩码加载，避免标量收尾
+        __mmask16 mask = (__mmask16)((1u << (n - i)) - 1u);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+void dot_rows_avx512(const float* q, const float* rows, size_t stride, size_t count, size_t n, float* out) {
+    for (size_t r = 0; r < count; ++r) out[r] = dot_avx512(q, rows + r * stride, n);
+}
+
+__attribute__((target("avx512f")))
+void dot4_avx512(const float* q0, const float* q1, const float* q2, const float* q3,
+                 const float* row, size_t n, float* out) {
+    __m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps(), a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 r = _mm512_loadu_ps(row + i);
+        a0 = _mm512_fmadd_ps(_mm512_loadu_ps(q0 + i), r, a0);
+        a1 = _mm512_fmadd_ps(_mm512_loadu_ps(q1 + i), r, a1);
+        a2 = _mm512_fmadd_ps(_mm512_loadu_ps(q2 + i), r, a2);
+        a3 = _mm512_fmadd_ps(_mm512_loadu_ps(q3 + i), r, a3);
+    }
+    if (i < n) {
+        __mmask16 mask = (__mmask16)((1u << (n - i)) - 1u);
+        __m512 r = _mm512_maskz_loadu_ps(mask, row + i);
+        a0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, q0 + i), r, a0);
+        a1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, q1 + i), r, a1);
+        a2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, q2 + i), r, a2);
+        a3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, q3 + i), r, a3);
+    }
+    out[0] = _mm512_reduce_add_ps(a0);
+    out[1] = _mm512_reduce_add_ps(a1);
+    out[2] = _mm512_reduce_add_ps(a2);
+    out[3] = _mm512_reduce_add_ps(a3);
+}
+
+__attribute__((target("avx512f")))
+void dot_block_avx512(const float* queries, size_t q_stride, size_t nq,
+                      const float* rows, size_t r_stride, size_t nr,
+                      size_t n, float* out, size_t out_stride) {
+    size_t i = 0;
+    for (; i + 4 <= nq; i += 4) {
+        const float* q = queries + i * q_stride;
+        float* o = out + i * out_stride;
+        for (size_t r = 0; r < nr; ++r) {
+            float s[4];
+            dot4_avx512(q, q + q_stride, q + 2 * q_stride, q + 3 * q_stride, rows + r * r_stride, n, s);
+            o[r] = s[0]; o[out_stride + r] = s[1]; o[2 * out_stride + r] = s[2]; o[3 * out_stride + r] = s[3];
+        }
+    }
+    for (; i < nq; ++i) {
+        dot_rows_avx512(queries + i * q_stride, rows, r_stride, nr, n, out + i * out_stride);
+    }
+}
+
+// ---------------- int8 ----------------
+// x86 的 u8×s8 乘加指令要求一侧无符号：用 |a| 与 sign(b, a) 相乘，乘积不变；
+// 分量限定在 [-127, 127]，相邻两项之和不超过 int16 范围，maddubs 不会饱和
+
+__attribute__((target("ssse3")))
+int32_t dot_i8_ssse3(const int8_t* a, const int8_t* b, size_t n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i prod = _mm_maddubs_epi16(_mm_abs_epi8(va), _mm_sign_epi8(vb, va));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(prod, ones));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int32_t sum = _mm_cvtsi128_si32(acc);
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+inline int32_t hsum_epi32_avx2(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+__attribute__((target("avx2")))
+int32_t dot_i8_avx2(const int8_t* a, const int8_t* b, size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i prod = _mm256_maddubs_epi16(_mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(prod, ones));
+    }
+    int32_t sum = hsum_epi32_avx2(acc);
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+#if defined(VECTOR_OPS_AVXVNNI)
+// AVX-VNNI：vpdpbusd 一条指令完成 4 组 u8×s8 乘加并累加到 int32
+__attribute__((target("avx2,avxvnni")))
+int32_t dot_i8_avxvnni(const int8_t* a, const int8_t* b, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i va0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i va1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+        __m256i vb1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+        acc0 = _mm256_dpbusd_avx_epi32(acc0, _mm256_abs_epi8(va0), _mm256_sign_epi8(vb0, va0));
+        acc1 = _mm256_dpbusd_avx_epi32(acc1, _mm256_abs_epi8(va1), _mm256_sign_epi8(vb1, va1));
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc0 = _mm256_dpbusd_avx_epi32(acc0, _mm256_abs_epi8(va), _mm256_sign_epi8(vb, va));
+    }
+    int32_t sum = hsum_epi32_avx2(_mm256_add_epi32(acc0, acc1));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+#endif
+
+// AVX-512 VNNI：AVX-512 没有 sign 指令，用符号位掩码对 b 取负
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+int32_t dot_i8_avx512vnni(const int8_t* a, const int8_t* b, size_t n) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i < n; i += 64) {
+        // 尾部用掩码加载，越界部分置零
+        __mmask64 mask = n - i >= 64 ? ~(__mmask64)0 : (((__mmask64)1 << (n - i)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi8(mask, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi8(mask, b + i);
+        __m512i signed_b = _mm512_mask_sub_epi8(vb, _mm512_movepi8_mask(va), zero, vb);
+        acc = _mm512_dpbusd_epi32(acc, _mm512_abs_epi8(va), signed_b);
+    }
+    return _mm512_reduce_add_epi32(acc);
+}
+
+// ---------------- 汉明距离 ----------------
+
+// 与标量版本相同，开启 popcnt 后编译器直接生成 popcnt 指令
+__attribute__((target("popcnt")))
+void hamming_rows_popcnt(const uint64_t* query, const uint64_t* rows, size_t words, size_t count, uint32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint64_t* row = rows + r * words;
+        uint64_t dist = 0;
+        for (size_t w = 0; w < words; ++w) dist += static_cast<uint64_t>(__builtin_popcountll(query[w] ^ row[w]));
+        out[r] = static_cast<uint32_t>(dist);
+    }
+}
+
+// ---------------- 半精度（F16C） ----------------
+
+__attribute__((target("avx2,fma,f16c")))
+inline __m256 load_fp16_avx2(const uint16_t* v) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)));
+}
+
+// bf16 即 float 的高 16 位：零扩展为 32 位后左移 16 位
+__attribute__((target("avx2,fma,f16c")))
+inline __m256 load_bf16_avx2(const uint16_t* v) {
+    __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16));
+}
+
+__attribute__((target("avx2,fma,f16c")))
+float dot_fp16_avx2(const float* q, const uint16_t* v, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), load_fp16_avx2(v + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), load_fp16_avx2(v + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), load_fp16_avx2(v + i), acc0);
+    }
+    float sum = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += q[i] * fp16_to_float(v[i]);
+    return sum;
+}
+
+__attribute__((target("avx2,fma,f16c")))
+float dot_bf16_avx2(const float* q, const uint16_t* v, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), load_bf16_avx2(v + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i + 8), load_bf16_avx2(v + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), load_bf16_avx2(v + i), acc0);
+    }
+    float sum = hsum_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) sum += q[i] * bf16_to_float(v[i]);
+    return sum;
+}
+
+__attribute__((target("avx2,fma,f16c")))
+void accumulate_fp16_avx2(float* acc, const uint16_t* v, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), load_fp16_avx2(v + i)));
+    }
+    for (; i < n; ++i) acc[i] += fp16_to_float(v[i]);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+void accumulate_bf16_avx2(float* acc, const uint16_t* v, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), load_bf16_avx2(v + i)));
+    }
+    for (; i < n; ++i) acc[i] += bf16_to_float(v[i]);
+}
+
+#endif // VECTOR_OPS_X86
+
+#ifdef VECTOR_OPS_NEON
+
+// ---------------- NEON ----------------
+
+inline float hsum_neon(float32x4_t v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+#endif
+}
+
+inline float32x4_t fma_neon(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    return vfmaq_f32(acc, a, b);
+#else
+    return vmlaq_f32(acc, a, b);
+#endif
+}
+
+float dot_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = fma_neon(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = fma_neon(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc2 = fma_neon(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        acc3 = fma_neon(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = fma_neon(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float sum = hsum_neon(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+void dot_rows_neon(const float* q, const float* rows, size_t stride, size_t count, size_t n, float* out) {
+    for (size_t r = 0; r < count; ++r) out[r] = dot_neon(q, rows + r * stride, n);
+}
+
+void dot4_neon(const float* q0, const float* q1, const float* q2, const float* q3,
+               const float* row, size_t n, float* out) {
+    float32x4_t a0 = vdupq_n_f32(0.0f), a1 = vdupq_n_f32(0.0f), a2 = vdupq_n_f32(0.0f), a3 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t r = vld1q_f32(row + i);
+        a0 = fma_neon(a0, vld1q_f32(q0 + i), r);
+        a1 = fma_neon(a1, vld1q_f32(q1 + i), r);
+        a2 = fma_neon(a2, vld1q_f32(q2 + i), r);
+        a3 = fma_neon(a3, vld1q_f32(q3 + i), r);
+    }
+    float s0 = hsum_neon(a0), s1 = hsum_neon(a1), s2 = hsum_neon(a2), s3 = hsum_neon(a3);
+    for (; i < n; ++i) {
+        s0 += q0[i] * row[i];
+        s1 += q1[i] * row[i];
+        s2 += q2[i] * row[i];
+        s3 += q3[i] * row[i];
+    }
+    out[0] = s0; out[1] = s1; out[2] = s2; out[3] = s3;
+}
+
+void dot_block_neon(const float* queries, size_t q_stride, size_t nq,
+                    const float* rows, size_t r_stride, size_t nr,
+                    size_t n, float* out, size_t out_stride) {
+    size_t i = 0;
+    for (; i + 4 <= nq; i += 4) {
+        const float* q = queries + i * q_stride;
+        float* o = out + i * out_stride;
+        for (size_t r = 0; r < nr; ++r) {
+            float s[4];
+            dot4_neon(q, q + q_stride, q + 2 * q_stride, q + 3 * q_stride, rows + r * r_stride, n, s);
+            o[r] = s[0]; o[out_stride + r] = s[1]; o[2 * out_stride + r] = s[2]; o[3 * out_stride + r] = s[3];
+        }
+    }
+    for (; i < nq; ++i) {
+        dot_rows_neon(queries + i * q_stride, rows, r_stride, nr, n, out + i * out_stride);
+    }
+}
+
+// int8：编译时开启 dotprod 扩展（armv8.2-a+dotprod）时用 SDOT，否则用 8 位乘法扩展到 16 位后累加
+int32_t dot_i8_neon(const int8_t* a, const int8_t* b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+#if defined(__ARM_FEATURE_DOTPROD)
+        acc = vdotq_s32(acc, va, vb);
+#else
+        // 分量限定在 [-127, 127]，两项乘积之和不超过 int16 范围
+        int16x8_t prod = vmull_s8(vget_low_s8(va), vget_low_s8(vb));
+        prod = vmlal_s8(prod, vget_high_s8(va), vget_high_s8(vb));
+        acc = vpadalq_s16(acc, prod);
+#endif
+    }
+#if defined(__aarch64__)
+    int32_t sum = vaddvq_s32(acc);
+#else
+    int32x2_t s = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    int32_t sum = vget_lane_s32(vpadd_s32(s, s), 0);
+#endif
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+#if defined(__aarch64__)
+
+// 半精度：aarch64 的 fcvtl 可直接把 4 个 fp16 扩展为 float；bf16 左移 16 位即为 float
+inline float32x4_t load_fp16_neon(const uint16_t* v) {
+    return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(v)));
+}
+
+inline float32x4_t load_bf16_neon(const uint16_t* v) {
+    return vreinterpretq_f32_u32(vshll_n_u16(vld1_u16(v), 16));
+}
+
+float dot_fp16_neon(const float* q, const uint16_t* v, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(q + i), load_fp16_neon(v + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(q + i + 4), load_fp16_neon(v + i + 4));
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) sum += q[i] * fp16_to_float(v[i]);
+    return sum;
+}
+
+float dot_bf16_neon(const float* q, const uint16_t* v, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(q + i), load_bf16_neon(v + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(q + i + 4), load_bf16_neon(v + i + 4));
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) sum += q[i] * bf16_to_float(v[i]);
+    return sum;
+}
+
+void accumulate_fp16_neon(float* acc, const uint16_t* v, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), load_fp16_neon(v + i)));
+    }
+    for (; i < n; ++i) acc[i] += fp16_to_float(v[i]);
+}
+
+void accumulate_bf16_neon(float* acc, const uint16_t* v, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vaddq_f32(vld1q_f32(acc + i), load_bf16_neon(v + i)));
+    }
+    for (; i < n; ++i) acc[i] += bf16_to_float(v[i]);
+}
+
+#endif // __aarch64__
+
+#endif // VECTOR_OPS_NEON
+
+Kernels select_kernels() {
+    const Kernels scalar = { "scalar", dot_scalar, dot_rows_scalar, dot_block_scalar };
+
+    // 允许通过环境变量 W2V_SIMD=scalar 强制使用标量实现，便于对比排查
+    const char* forced = std::getenv("W2V_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return scalar;
+    }
+
+#if defined(VECTOR_OPS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        const Kernels k = { "avx512", dot_avx512, dot_rows_avx512, dot_block_avx512 };
+        return k;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        const Kernels k = { "avx2", dot_avx2, dot_rows_avx2, dot_block_avx2 };
+        return k;
+    }
+    const Kernels k = { "sse", dot_sse, dot_rows_sse, dot_block_sse };
+    return k;
+#elif defined(VECTOR_OPS_NEON)
+    // aarch64 必然支持 NEON；armv7 仅在编译时开启 NEON（-mfpu=neon）时走到这里
+    const Kernels k = { "neon", dot_neon, dot_rows_neon, dot_block_neon };
+    return k;
+#else
+    return scalar;
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels k = select_kernels();
+    return k;
+}
+
+Int8Kernels select_int8_kernels() {
+    const Int8Kernels scalar = { "scalar", dot_i8_scalar };
+
+    const char* forced = std::getenv("W2V_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return scalar;
+    }
+
+#if defined(VECTOR_OPS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        const Int8Kernels k = { "avx512vnni", dot_i8_avx512vnni };
+        return k;
+    }
+#if defined(VECTOR_OPS_AVXVNNI)
+    if (__builtin_cpu_supports("avxvnni")) {
+        const Int8Kernels k = { "avxvnni", dot_i8_avxvnni };
+        return k;
+    }
+#endif
+    if (__builtin_cpu_supports("avx2")) {
+        const Int8Kernels k = { "avx2", dot_i8_avx2 };
+        return k;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        const Int8Kernels k = { "ssse3", dot_i8_ssse3 };
+        return k;
+    }
+    return scalar;
+#elif defined(VECTOR_OPS_NEON)
+#if defined(__ARM_FEATURE_DOTPROD)
+    const Int8Kernels k = { "neon-dotprod", dot_i8_neon };
+#else
+    const Int8Kernels k = { "neon", dot_i8_neon };
+#endif
+    return k;
+#else
+    return scalar;
+#endif
+}
+
+const Int8Kernels& int8_kernels() {
+    static const Int8Kernels k = select_int8_kernels();
+    return k;
+}
+
+BitKernels select_bit_kernels() {
+    const BitKernels scalar = { "scalar", hamming_rows_scalar };
+
+#if defined(VECTOR_OPS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")) {
+        const BitKernels k = { "popcnt", hamming_rows_popcnt };
+        return k;
+    }
+#endif
+    // ARM 上 __builtin_popcountll 直接编译为 NEON cnt 指令
+    return scalar;
+}
+
+const BitKernels& bit_kernels() {
+    static const BitKernels k = select_bit_kernels();
+    return k;
+}
+
+HalfKernels select_half_kernels() {
+    const HalfKernels scalar = { "scalar", dot_fp16_scalar, dot_bf16_scalar,
+                                 accumulate_fp16_scalar, accumulate_bf16_scalar };
+
+    const char* forced = std::getenv("W2V_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return scalar;
+    }
+
+#if defined(VECTOR_OPS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")) {
+        const HalfKernels k = { "f16c", dot_fp16_avx2, dot_bf16_avx2, accumulate_fp16_avx2, accumulate_bf16_avx2 };
+        return k;
+    }
+    return scalar;
+#elif defined(VECTOR_OPS_NEON) && defined(__aarch64__)
+    const HalfKernels k = { "neon", dot_fp16_neon, dot_bf16_neon, accumulate_fp16_neon, accumulate_bf16_neon };
+    return k;
+#else
+    // armv7 的 NEON 不保证支持半精度转换，使用标量实现
+    return scalar;
+#endif
+}
+
+const HalfKernels& half_kernels() {
+    static const HalfKernels k = select_half_kernels();
+    return k;
+}
+
+} // namespace
+
+float VectorOps::dot(const float* a, const float* b, size_t n) {
+    return kernels().dot(a, b, n);
+}
+
+void VectorOps::dot_rows(const float* query, const float* rows, size_t stride,
+                         size_t count, size_t n, float* out) {
+    kernels().dot_rows(query, rows, stride, count, n, out);
+}
+
+void VectorOps::dot_block(const float* queries, size_t query_stride, size_t query_count,
+                          const float* rows, size_t row_stride, size_t row_count,
+                          size_t n, float* out, size_t out_stride) {
+    kernels().dot_block(queries, query_stride, query_count, rows, row_stride, row_count, n, out, out_stride);
+}
+
+float VectorOps::squared_norm(const float* a, size_t n) {
+    return kernels().dot(a, a, n);
+}
+
+void VectorOps::scale(float* v, size_t n, float factor) {
+    for (size_t i = 0; i < n; ++i) v[i] *= factor;
+}
+
+float VectorOps::l2_normalize(float* v, size_t n, float eps) {
+    float norm = std::sqrt(squared_norm(v, n));
+    if (norm > eps) {
+        scale(v, n, 1.0f / norm);
+    }
+    return norm;
+}
+
+const char* VectorOps::kernel_name() {
+    return kernels().name;
+}
+
+int32_t VectorOps::dot_i8(const int8_t* a, const int8_t* b, size_t n) {
+    return int8_kernels().dot(a, b, n);
+}
+
+void VectorOps::dot_rows_i8(const int8_t* query, const int8_t* rows, size_t stride,
+                            size_t count, size_t n, int32_t* out) {
+    DotI8Fn dot = int8_kernels().dot;
+    for (size_t r = 0; r < count; ++r) out[r] = dot(query, rows + r * stride, n);
+}
+
+const char* VectorOps::int8_kernel_name() {
+    return int8_kernels().name;
+}
+
+float VectorOps::dot_half(const float* query, const uint16_t* row, size_t n, HalfType type) {
+    const HalfKernels& k = half_kernels();
+    return type == HALF_FP16 ? k.dot_fp16(query, row, n) : k.dot_bf16(query, row, n);
+}
+
+void VectorOps::dot_rows_half(const float* query, const uint16_t* rows, size_t stride,
+                              size_t count, size_t n, HalfType type, float* out) {
+    const HalfKernels& k = half_kernels();
+    DotHalfFn dot = type == HALF_FP16 ? k.dot_fp16 : k.dot_bf16;
+    for (size_t r = 0; r < count; ++r) out[r] = dot(query, rows + r * stride, n);
+}
+
+void VectorOps::accumulate_half(float* acc, const uint16_t* v, size_t n, HalfType type) {
+    const HalfKernels& k = half_kernels();
+    if (type == HALF_FP16) {
+        k.accumulate_fp16(acc, v, n);
+    } else {
+        k.accumulate_bf16(acc, v, n);
+    }
+}
+
+const char* VectorOps::half_kernel_name() {
+    return half_kernels().name;
+}
+
+void VectorOps::hamming_rows(const uint64_t* query, const uint64_t* rows, size_t words,
+                             size_t count, uint32_t* out) {
+    bit_kernels().hamming_rows(query, rows, words, count, out);
+}
@@ -0,0 +1,92 @@
+#include "../include/VocabHashTable.h"
+
+namespace {
+
+// 装载因子上限（元素数 / 槽位数）为 1/2，线性探测的平均探测长度保持在 2 以内
+const size_t kMinCapacity = 16;
+
+} // namespace
+
+VocabHashTable::VocabHashTable() : offsets_(1, 0) {}
+
+uint32_t VocabHashTable::hash_word(std::string_view word) {
+    // FNV-1a，最后做一次混合使低位分布均匀（槽位按低位取模）
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < word.size(); ++i) {
+        h ^= static_cast<unsigned char>(word[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+size_t VocabHashTable::probe(std::string_view word, uint32_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    size_t pos = hash & mask;
+    while (true) {
+        const Slot& slot = slots_[pos];
+        if (slot.row == kNotFound) return pos;
+        if (slot.hash == hash && this->word(slot.row) == word) return pos;
+        pos = (pos + 1) & mask;
+    }
+}
+
+void VocabHashTable::rehash(size_t capacity) {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    Slot empty = { kNotFound, 0 };
+    slots_.assign(capacity, empty);
+    const size_t mask = capacity - 1;
+    // 哈希值已保存在槽位中，扩容时无需重新计算
+    for (size_t i = 0; i < old.size(); ++i) {
+        if (old[i].row == kNotFound) continue;
+        size_t pos = old[i].hash & mask;
+        while (slots_[pos].row != kNotFound) pos = (pos + 1) & mask;
+        slots_[pos] = old[i];
+    }
+}
+
+void VocabHashTable::reserve(size_t count) {
+    size_t capacity = kMinCapacity;
+    while (capacity < count * 2) capacity <<= 1;
+    if (capacity > slots_.size()) rehash(capacity);
+    offsets_.reserve(count + 1);
+}
+
+std::pair<uint32_t, bool> VocabHashTable::insert(std::string_view word) {
+    return insert(word, hash_word(word));
+}
+
+std::pair<uint32_t, bool> VocabHashTable::insert(std::string_view word, uint32_t hash) {
+    if ((size() + 1) * 2 > slots_.size()) {
+        rehash(slots_.empty() ? kMinCapacity : slots_.size() * 2);
+    }
+    size_t pos = probe(word, hash);
+    if (slots_[pos].row != kNotFound) {
+        return std::make_pair(slots_[pos].row, false);
+    }
+    uint32_t row = static_cast<uint32_t>(size());
+    arena_.append(word.data(), word.size());
+    offsets_.push_back(arena_.size());
+    slots_[pos].row = row;
+    slots_[pos].hash = hash;
+    return std::make_pair(row, true);
+}
+
+uint32_t VocabHashTable::find(std::string_view word) const {
+    if (slots_.empty()) return kNotFound;
+    return slots_[probe(word, hash_word(word))].row;
+}
+
+size_t VocabHashTable::get_memory_usage() const {
+    return slots_.capacity() * sizeof(Slot) + arena_.capacity() + offsets_.capacity() * sizeof(uint64_t);
+}
+
+void VocabHashTable::clear() {
+    std::vector<Slot>().swap(slots_);
+    std::string().swap(arena_);
+    offsets_.assign(1, 0);
+    offsets_.shrink_to_fit();
+}
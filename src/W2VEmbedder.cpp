@@ -1,16 +1,346 @@
 #include "../include/W2VEmbedder.h"
+#include "../include/VectorOps.h"
+#include "../include/ThreadPool.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cerrno>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
 
-W2VEmbedder::W2VEmbedder() : embedding_dim_(0), max_word_len_(0), initialized_(false) {}
+namespace {
 
-bool W2VEmbedder::initialize(const std::string& model_path) {
+// 二进制词表格式的文件头（小端，64 字节），由 scripts/convert_w2v.py 生成
+const char kBinaryModelMagic[8] = {'W', '2', 'V', 'B', 'I', 'N', '\0', '\0'};
+const uint32_t kBinaryModelVersion = 1;
+
+struct BinaryModelHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dim;
+    uint64_t vocab_size;
+    uint32_t dtype;             // 向量元素类型，取值同 VectorPrecision
+    uint32_t max_word_len;      // 最长词的字节数
+    uint64_t words_offset;      // 词表：[offsets: u64 × (vocab_size + 1)] + 字符数据，词按字节序升序排列
+    uint64_t matrix_offset;     // 词向量矩阵 [vocab_size, dim]，行号与词序一致，按 64 字节对齐
+    uint64_t reserved[2];
+};
+static_assert(sizeof(BinaryModelHeader) == 64, "BinaryModelHeader must be 64 bytes");
+
+// 文本格式按约 4MB 切块并行解析，块边界后移到行尾
+const size_t kTextChunkBytes = 4 << 20;
+// 解析完成后按行块并行拷贝 / 转换词向量
+const size_t kCopyRowsPerTask = 4096;
+
+// 与 istream 的空白字符一致
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// 从 p 解析一个浮点数，成功时返回数字之后的位置，失败返回 nullptr。
+// 与 istream >> float 接受的写法一致：可选正负号 + 十进制数字 / 小数点 / 指数，不接受 inf、nan 与十六进制
+const char* parse_float(const char* p, const char* end, float& value) {
+    const char* digits = p < end && (*p == '+' || *p == '-') ? p + 1 : p;
+    if (digits == end || !(isdigit((unsigned char)*digits) || *digits == '.')) return nullptr;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    // from_chars 不接受前导 '+'
+    std::from_chars_result result = std::from_chars(*p == '+' ? digits : p, end, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    // 标准库未提供浮点 from_chars（如 NDK r25 的 libc++）：映射的文件不以 '\0' 结尾，复制到栈上再用 strtof
+    char buf[64];
+    size_t len = 0;
+    while (p + len < end && len + 1 < sizeof(buf) && !is_space(p[len])) {
+        buf[len] = p[len];
+        len++;
+    }
+    buf[len] = '\0';
+    char* stop = nullptr;
+    errno = 0;
+    value = std::strtof(buf, &stop);
+    if (stop == buf || errno == ERANGE) return nullptr;
+    return p + (stop - buf);
+#endif
+}
+
+// 一个切块的解析结果：每个有效行（词后至少一个数）记录词、词的哈希与解析出的数，行内的数依次拼接
+struct TextChunk {
+    const char* begin;
+    const char* end;
+    std::vector<std::string_view> words;
+    std::vector<uint32_t> hashes;
+    std::vector<uint32_t> counts;
+    std::vector<float> values;
+};
+
+// 逐行解析，语义同 `iss >> word; while (iss >> val) vec.push_back(val);`
+void parse_text_chunk(TextChunk& chunk) {
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        if (!line_end) line_end = chunk.end;
+
+        while (p < line_end && is_space(*p)) p++;
+        const char* word_begin = p;
+        while (p < line_end && !is_space(*p)) p++;
+        std::string_view word(word_begin, static_cast<size_t>(p - word_begin));
+
+        size_t count = 0;
+        while (true) {
+            while (p < line_end && is_space(*p)) p++;
+            if (p == line_end) break;
+            float value;
+            const char* next = parse_float(p, line_end, value);
+            if (!next) break;
+            chunk.values.push_back(value);
+            count++;
+            p = next;
+        }
+        if (count > 0) {
+            chunk.words.push_back(word);
+            chunk.hashes.push_back(VocabHashTable::hash_word(word));
+            chunk.counts.push_back(static_cast<uint32_t>(count));
+        }
+        p = line_end + 1;
+    }
+}
+
+} // namespace
+
+W2VEmbedder::W2VEmbedder()
+    : precision_(PRECISION_FLOAT32), embedding_dim_(0), initialized_(false),
+      mapped_word_offsets_(nullptr), mapped_words_(nullptr), mapped_vocab_size_(0),
+      float_rows_(nullptr), half_rows_(nullptr) {}
+
+void W2VEmbedder::reset() {
+    vocab_.clear();
+    vectors_.clear();
+    half_vectors_.clear();
+    mapped_.reset();
+    mapped_word_offsets_ = nullptr;
+    mapped_words_ = nullptr;
+    mapped_vocab_size_ = 0;
+    float_rows_ = nullptr;
+    half_rows_ = nullptr;
+    trie_.clear();
+    embedding_dim_ = 0;
+    initialized_ = false;
+}
+
+bool W2VEmbedder::find_word(std::string_view word, uint32_t& index) const {
+    if (!mapped_) {
+        index = vocab_.find(word);
+        return index != VocabHashTable::kNotFound;
+    }
+    // string_view 按无符号字节比较，与转换脚本对 bytes 的排序规则一致
+    size_t lo = 0, hi = mapped_vocab_size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const uint64_t begin = mapped_word_offsets_[mid];
+        std::string_view entry(mapped_words_ + begin, static_cast<size_t>(mapped_word_offsets_[mid + 1] - begin));
+        int c = entry.compare(word);
+        if (c == 0) {
+            index = static_cast<uint32_t>(mid);
+            return true;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+bool W2VEmbedder::load_binary_model(const std::string& model_path) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->open(model_path)) return false;
+
+    BinaryModelHeader header;
+    if (file->size() < sizeof(header)) return false;
+    std::memcpy(&header, file->data(), sizeof(header));
+    const uint64_t file_size = file->size();
+    const uint64_t elem_size = header.dtype == PRECISION_FLOAT32 ? sizeof(float) : sizeof(uint16_t);
+    if (header.version != kBinaryModelVersion || header.dim == 0 || header.dtype > PRECISION_BF16 ||
+        header.vocab_size >= 0xffffffffull || header.matrix_offset % 64 != 0 ||
+        header.words_offset > file_size ||
+        (file_size - header.words_offset) / sizeof(uint64_t) <= header.vocab_size ||
+        header.matrix_offset > file_size ||
+        (file_size - header.matrix_offset) / elem_size / header.dim < header.vocab_size) {
+        std::cerr << "二进制词向量文件格式错误: " << model_path << std::endl;
+        return false;
+    }
+
+    // 校验词偏移单调且不越界、词严格升序（二分查找与 Trie 构建依赖有序），之后的查找无需再做边界检查
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file->data() + header.words_offset);
+    const uint64_t blob_start = header.words_offset + (header.vocab_size + 1) * sizeof(uint64_t);
+    const char* words = file->data() + blob_start;
+    bool valid = header.words_offset % sizeof(uint64_t) == 0 && offsets[0] == 0 &&
+                 offsets[header.vocab_size] <= file_size - blob_start;
+    for (uint64_t i = 0; valid && i < header.vocab_size; ++i) {
+        valid = offsets[i] <= offsets[i + 1];
+    }
+    for (uint64_t i = 1; valid && i < header.vocab_size; ++i) {
+        std::string_view prev(words + offsets[i - 1], static_cast<size_t>(offsets[i] - offsets[i - 1]));
+        std::string_view cur(words + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i]));
+        valid = prev < cur;
+    }
+    if (!valid) {
+        std::cerr << "二进制词向量文件格式错误: " << model_path << std::endl;
+        return false;
+    }
+
+    precision_ = static_cast<VectorPrecision>(header.dtype);
+    embedding_dim_ = static_cast<int>(header.dim);
+    mapped_word_offsets_ = offsets;
+    mapped_words_ = words;
+    mapped_vocab_size_ = static_cast<size_t>(header.vocab_size);
+    if (precision_ == PRECISION_FLOAT32) {
+        float_rows_ = reinterpret_cast<const float*>(file->data() + header.matrix_offset);
+    } else {
+        half_rows_ = reinterpret_cast<const uint16_t*>(file->data() + header.matrix_offset);
+    }
+    // 词向量矩阵不在启动时读取，各行在首次命中时才换入；按行随机访问，关闭预读以免连带换入大量用不到的行
+    file->advise_random(static_cast<size_t>(header.matrix_offset),
+                        static_cast<size_t>(header.vocab_size * header.dim * elem_size));
+    mapped_ = std::move(file);
+    return true;
+}
+
+bool W2VEmbedder::load_text_model(const std::string& model_path) {
+    MappedFile file;
+    if (!file.open(model_path)) {
+        // 空文件无法映射，按空词表处理
+        std::ifstream probe(model_path, std::ios::binary);
+        return probe.is_open() && probe.peek() == std::ifstream::traits_type::eof();
+    }
+
+    // 1. 按行边界切块
+    std::vector<TextChunk> chunks;
+    const char* end = file.data() + file.size();
+    for (const char* p = file.data(); p < end;) {
+        const char* stop = p + std::min(kTextChunkBytes, static_cast<size_t>(end - p));
+        const char* newline = static_cast<const char*>(std::memchr(stop - 1, '\n', end - stop + 1));
+        stop = newline ? newline + 1 : end;
+        TextChunk chunk;
+        chunk.begin = p;
+        chunk.end = stop;
+        chunks.push_back(chunk);
+        p = stop;
+    }
+
+    size_t hardware_threads = std::thread::hardware_concurrency();
+    std::unique_ptr<ThreadPool> pool;
+    if (chunks.size() > 1 && hardware_threads > 1) {
+        pool.reset(new ThreadPool(std::min(hardware_threads, chunks.size()) - 1));
+    }
+    auto run = [&pool](size_t count, const std::function<void(size_t)>& fn) {
+        if (pool) {
+            pool->parallel_for(count, fn);
+        } else {
+            for (size_t i = 0; i < count; ++i) fn(i);
+        }
+    };
+
+    // 2. 各块并行解析数字并计算词的哈希
+    run(chunks.size(), [&chunks](size_t c) { parse_text_chunk(chunks[c]); });
+
+    // 3. 按文件顺序串行插入词表：行号与重复词的处理（后出现的向量覆盖）与逐行读取一致。
+    //    维度由第一个有效行决定，维度不一致的行无法放入定长词向量表，跳过
+    size_t total_lines = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        if (embedding_dim_ == 0 && !chunks[c].counts.empty()) embedding_dim_ = static_cast<int>(chunks[c].counts[0]);
+        total_lines += chunks[c].words.size();
+    }
+    const size_t dim = static_cast<size_t>(embedding_dim_);
+    vocab_.reserve(total_lines);
+    std::vector<const float*> sources;
+    sources.reserve(total_lines);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        const TextChunk& chunk = chunks[c];
+        const float* values = chunk.values.data();
+        for (size_t i = 0; i < chunk.words.size(); ++i) {
+            if (chunk.counts[i] == dim) {
+                std::pair<uint32_t, bool> inserted = vocab_.insert(chunk.words[i], chunk.hashes[i]);
+                if (inserted.second) {
+                    sources.push_back(values);
+                } else {
+                    sources[inserted.first] = values;
+                }
+            }
+            values += chunk.counts[i];
+        }
+    }
+
+    // 4. 并行拷贝（或转换为半精度）到词向量表
+    const size_t rows = sources.size();
+    if (precision_ == PRECISION_FLOAT32) {
+        vectors_.resize(rows * dim);
+    } else {
+        half_vectors_.resize(rows * dim);
+    }
+    const HalfType half_type = precision_ == PRECISION_FP16 ? HALF_FP16 : HALF_BF16;
+    run((rows + kCopyRowsPerTask - 1) / kCopyRowsPerTask, [&](size_t t) {
+        size_t row_end = std::min(rows, (t + 1) * kCopyRowsPerTask);
+        for (size_t r = t * kCopyRowsPerTask; r < row_end; ++r) {
+            if (precision_ == PRECISION_FLOAT32) {
+                std::copy(sources[r], sources[r] + dim, vectors_.begin() + r * dim);
+            } else {
+                float_to_half(sources[r], half_vectors_.data() + r * dim, dim, half_type);
+            }
+        }
+    });
+    return true;
+}
+
+void W2VEmbedder::add_word(const std::string& word, const float* vec) {
+    const size_t dim = static_cast<size_t>(embedding_dim_);
+    std::pair<uint32_t, bool> inserted = vocab_.insert(word);
+    size_t offset = static_cast<size_t>(inserted.first) * dim;
+    // 重复的词覆盖原有向量
+    if (precision_ == PRECISION_FLOAT32) {
+        if (inserted.second) vectors_.resize(offset + dim);
+        std::copy(vec, vec + dim, vectors_.begin() + offset);
+    } else {
+        if (inserted.second) half_vectors_.resize(offset + dim);
+        float_to_half(vec, half_vectors_.data() + offset, dim, precision_ == PRECISION_FP16 ? HALF_FP16 : HALF_BF16);
+    }
+}
+
+void W2VEmbedder::accumulate(uint32_t index, float* acc) const {
+    const size_t dim = static_cast<size_t>(embedding_dim_);
+    size_t offset = static_cast<size_t>(index) * dim;
+    if (precision_ == PRECISION_FLOAT32) {
+        const float* vec = float_rows_ + offset;
+        for (size_t i = 0; i < dim; ++i) acc[i] += vec[i];
+    } else {
+        VectorOps::accumulate_half(acc, half_rows_ + offset, dim,
+                                   precision_ == PRECISION_FP16 ? HALF_FP16 : HALF_BF16);
+    }
+}
+
+bool W2VEmbedder::initialize(const std::string& model_path, VectorPrecision precision) {
     std::ifstream file(model_path, std::ios::binary);
     if (!file.is_open()) return false;
     
+    reset();
+    char magic[sizeof(kBinaryModelMagic)] = {};
+    file.read(magic, sizeof(magic));
+    if (file.gcount() == sizeof(magic) && std::memcmp(magic, kBinaryModelMagic, sizeof(magic)) == 0) {
+        if (!load_binary_model(model_path)) return false;
+        finish_load();
+        return true;
+    }
+    file.clear();
+    file.seekg(0);
+    
+    precision_ = precision;
+    
     std::string header;
     std::getline(file, header);
     std::istringstream header_stream(header);
@@ -20,113 +350,114 @@ bool W2VEmbedder::initialize(const std::string& model_path) {
     if (vocab_size <= 0 || embedding_dim_ <= 0) {
         file.close();
         // 尝试无头格式
-        std::ifstream file2(model_path);
-        std::string line;
-        while (std::getline(file2, line)) {
-            std::istringstream iss(line);
-            std::string word;
-            iss >> word;
-            std::vector<float> vec;
-            float val;
-            while (iss >> val) vec.push_back(val);
-            if (!vec.empty()) {
-                if (embedding_dim_ == 0) embedding_dim_ = vec.size();
-                word_vectors_[word] = vec;
-                max_word_len_ = std::max(max_word_len_, (int)word.length());
-            }
-        }
+        if (!load_text_model(model_path)) return false;
     } else {
+        vocab_.reserve(vocab_size);
+        if (precision_ == PRECISION_FLOAT32) {
+            vectors_.reserve((size_t)vocab_size * embedding_dim_);
+        } else {
+            half_vectors_.reserve((size_t)vocab_size * embedding_dim_);
+        }
+        std::vector<float> vec(embedding_dim_);
         for (int i = 0; i < vocab_size; ++i) {
             std::string word;
             file >> word;
             file.get(); // skip space
-            std::vector<float> vec(embedding_dim_);
             file.read((char*)vec.data(), embedding_dim_ * sizeof(float));
-            word_vectors_[word] = vec;
-            max_word_len_ = std::max(max_word_len_, (int)word.length());
+            add_word(word, vec.data());
         }
     }
     
-    zero_vector_.assign(embedding_dim_, 0.0f);
-    initialized_ = true;
+    float_rows_ = vectors_.data();
+    half_rows_ = half_vectors_.data();
+    finish_load();
     return true;
 }
 
-std::vector<std::string> W2VEmbedder::tokenize_chinese(const std::string& text) {
-    std::vector<std::string> tokens;
+void W2VEmbedder::finish_load() {
+    // 按字节序排好的词表编译为双数组 Trie（映射的二进制词表本身有序，行号即序号）
+    std::vector<std::string_view> words;
+    std::vector<uint32_t> rows;
+    if (mapped_) {
+        words.reserve(mapped_vocab_size_);
+        for (size_t i = 0; i < mapped_vocab_size_; ++i) {
+            words.push_back(std::string_view(mapped_words_ + mapped_word_offsets_[i],
+                                             static_cast<size_t>(mapped_word_offsets_[i + 1] - mapped_word_offsets_[i])));
+        }
+        rows.resize(words.size());
+        for (size_t i = 0; i < rows.size(); ++i) rows[i] = static_cast<uint32_t>(i);
+    } else {
+        rows.resize(vocab_.size());
+        for (size_t i = 0; i < rows.size(); ++i) rows[i] = static_cast<uint32_t>(i);
+        std::sort(rows.begin(), rows.end(),
+                  [this](uint32_t a, uint32_t b) { return vocab_.word(a) < vocab_.word(b); });
+        words.reserve(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) words.push_back(vocab_.word(rows[i]));
+    }
+    trie_.build(words, rows);
+
+    initialized_ = true;
+}
+
+template <typename Visitor>
+void W2VEmbedder::for_each_word(std::string_view text, Visitor&& visit) const {
     size_t i = 0;
     while (i < text.length()) {
         if ((text[i] & 0x80) == 0) {
+            // ASCII：字母数字与下划线连成一个词整体查表，其余字符跳过
             if (isspace(text[i])) { i++; continue; }
-            std::string token;
+            size_t begin = i;
             while (i < text.length() && (text[i] & 0x80) == 0 && (isalnum(text[i]) || text[i] == '_')) {
-                token += text[i++];
+                i++;
             }
-            if (!token.empty()) tokens.push_back(token);
-            else if (i < text.length()) i++;
-            continue;
-        }
-        bool matched = false;
-        size_t remaining_len = text.length() - i;
-        size_t match_limit = std::min((size_t)max_word_len_, remaining_len);
-        for (size_t len = match_limit; len > 0; --len) {
-            std::string sub = text.substr(i, len);
-            if (word_vectors_.count(sub)) {
-                tokens.push_back(sub);
-                i += len;
-                matched = true;
-                break;
+            uint32_t index;
+            if (i > begin) {
+                if (find_word(text.substr(begin, i - begin), index)) visit(index);
+            } else {
+                i++;
             }
+            continue;
         }
-        if (!matched) {
+        // 单趟 Trie 遍历得到从 i 开始的最长词；无匹配时该字符不在词表中，跳过一个 UTF-8 字符
+        uint32_t index;
+        size_t len = trie_.longest_match(text.data() + i, text.length() - i, index);
+        if (len > 0) {
+            visit(index);
+            i += len;
+        } else {
             size_t char_len = 1;
             unsigned char c = (unsigned char)text[i];
             if (c >= 0xF0) char_len = 4;
             else if (c >= 0xE0) char_len = 3;
             else if (c >= 0xC0) char_len = 2;
             if (i + char_len > text.length()) char_len = text.length() - i;
-            tokens.push_back(text.substr(i, char_len));
             i += char_len;
         }
     }
-    return tokens;
 }
 
 std::vector<float> W2VEmbedder::embed(const std::string& text) {
     if (!initialized_) return std::vector<float>();
-    std::vector<std::string> tokens = tokenize_chinese(text);
-    if (tokens.empty()) return zero_vector_;
     
+    // 分词与求和一趟完成：词直接以行号给出，不生成中间字符串
     std::vector<float> res(embedding_dim_, 0.0f);
     int count = 0;
-    for (const auto& token : tokens) {
-        if (word_vectors_.count(token)) {
-            const auto& vec = word_vectors_[token];
-            for (int i = 0; i < embedding_dim_; ++i) res[i] += vec[i];
-            count++;
-        }
-    }
+    for_each_word(text, [&](uint32_t index) {
+        accumulate(index, res.data());
+        count++;
+    });
     
     if (count > 0) {
-        float norm = 0;
-        for (int i = 0; i < embedding_dim_; ++i) {
-            res[i] /= count;
-            norm += res[i] * res[i];
-        }
-        norm = std::sqrt(norm);
-        if (norm > 1e-6) {
-            for (int i = 0; i < embedding_dim_; ++i) res[i] /= norm;
-        }
+        VectorOps::scale(res.data(), res.size(), 1.0f / count);
+        VectorOps::l2_normalize(res.data(), res.size(), 1e-6f);
     }
     return res;
 }
 
 size_t W2VEmbedder::get_memory_usage() const {
-    size_t total = 0;
-    for (const auto& pair : word_vectors_) {
-        total += pair.first.capacity();
-        total += pair.second.capacity() * sizeof(float);
-        total += 32; // map node overhead approx
-    }
+    size_t total = vectors_.capacity() * sizeof(float) + half_vectors_.capacity() * sizeof(uint16_t) +
+                   vocab_.get_memory_usage() + trie_.get_memory_usage();
+    // 映射的二进制词表只计实际驻留的页（只读页可被系统回收）
+    if (mapped_) total += mapped_->resident_size();
     return total;
 }